@@ -0,0 +1,41 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the bench_*.cpp benchmarks.
+#include <ctime>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/time.h>
+#endif
+
+/**
+ * XorShift32
+ * Small xorshift generator, so every run, and every variant a benchmark
+ * compares, sees the same inputs. The seed must be non-zero.
+ */
+struct XorShift32 {
+    unsigned int state;
+    explicit XorShift32(unsigned int seed) : state(seed) {}
+    unsigned int next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+// CPU seconds since start (a clock() reading).
+inline double seconds_since(clock_t start) {
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Wall-clock seconds, for the multi-threaded benchmarks: clock() would add
+// up the CPU time of all threads.
+inline double wall_seconds() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+#endif
+
+#endif // BENCH_UTIL_H
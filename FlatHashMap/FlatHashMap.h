@@ -0,0 +1,397 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+// Open-addressing hash map with SIMD control-byte probing.
+#include "DynamicallySizedArray.h"
+#include "HashMix.h"
+#include <cassert>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * FlatHashMap
+ * An unordered map from K to V with open addressing and linear probing.
+ *
+ *  - Storage is three parallel DynamicallySizedArrays: one control byte per
+ *    slot, the keys and the values. A control byte is EMPTY or the top 7
+ *    bits of the key's hash (its fingerprint); the low hash bits pick the
+ *    home slot.
+ *  - A lookup loads GROUP_WIDTH (16) control bytes at once and compares
+ *    them all with the fingerprint and with EMPTY (SSE2 where available,
+ *    a byte loop otherwise). Only slots whose fingerprint matches have
+ *    their key compared, and the first group holding an EMPTY byte ends the
+ *    search. The first GROUP_WIDTH control bytes are mirrored past the end,
+ *    so a group never wraps.
+ *  - erase shifts the following entries of the probe run back into the
+ *    hole (no tombstones), so lookups never slow down after many erases.
+ *  - The capacity is a power of two (at least GROUP_WIDTH); the table
+ *    doubles before it is more than 3/4 full.
+ *
+ * find() returns a pointer to the value (NULL if absent), valid until the
+ * next insert, erase, reserve or clear.
+ */
+template <typename K, typename V> class FlatHashMap {
+  private:
+    static const int GROUP_WIDTH = 16;
+    static const unsigned char EMPTY = 0x80;
+    // insert_batch() prefetches the home slot this many keys ahead.
+    static const int PREFETCH_DISTANCE = 8;
+
+    DynamicallySizedArray<unsigned char> _control; // capacity + GROUP_WIDTH.
+    DynamicallySizedArray<K> _keys;
+    DynamicallySizedArray<V> _values;
+    int _size;
+    unsigned int _mask; // capacity - 1 (0 while there are no slots).
+
+    static unsigned char fingerprint(unsigned int hash) {
+        return static_cast<unsigned char>(hash >> 25);
+    }
+
+    static void prefetch(const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    int capacity_slots() const {
+        return _keys.size();
+    }
+
+    /**
+     * @brief Compares the GROUP_WIDTH control bytes at position with a
+     * fingerprint and with EMPTY.
+     *
+     * @param matches Receives bit i set if byte i equals the fingerprint.
+     * @param empties Receives bit i set if byte i is EMPTY.
+     */
+    void match_group(unsigned int position, unsigned char fp,
+                     unsigned int& matches, unsigned int& empties) const {
+        const unsigned char* group = &_control[0] + position;
+#if defined(__SSE2__)
+        __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        matches = static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(fp)))));
+        empties = static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(EMPTY)))));
+#else
+        matches = 0;
+        empties = 0;
+        for (int i = 0; i < GROUP_WIDTH; ++i) {
+            matches |= static_cast<unsigned int>(group[i] == fp) << i;
+            empties |= static_cast<unsigned int>(group[i] == EMPTY) << i;
+        }
+#endif
+    }
+
+    // Index of the lowest set bit (mask must not be 0).
+    static int lowest_bit(unsigned int mask) {
+#if defined(__GNUC__)
+        return __builtin_ctz(mask);
+#else
+        int bit = 0;
+        while ((mask & 1u) == 0) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static bool same_key(const K& a, const K& b) {
+        return a == b;
+    }
+
+    /**
+     * @brief Looks key up, group by group from its home slot.
+     *
+     * @param hash KeyHash<K>::hash(key).
+     * @param insert_slot Receives the first EMPTY slot on the probe run
+     * (where key would be inserted) when key is absent.
+     *
+     * @return The slot holding key, or -1.
+     */
+    int find_slot(const K& key, unsigned int hash, int& insert_slot) const {
+        unsigned char fp = fingerprint(hash);
+        unsigned int position = hash & _mask;
+        for (;;) {
+            unsigned int matches;
+            unsigned int empties;
+            match_group(position, fp, matches, empties);
+            while (matches != 0) {
+                int slot =
+                    static_cast<int>((position + lowest_bit(matches)) & _mask);
+                if (same_key(_keys[slot], key)) {
+                    return slot;
+                }
+                matches &= matches - 1;
+            }
+            if (empties != 0) {
+                insert_slot =
+                    static_cast<int>((position + lowest_bit(empties)) & _mask);
+                return -1;
+            }
+            position = (position + GROUP_WIDTH) & _mask;
+        }
+    }
+
+    // Sets a control byte and its mirror past the end.
+    void set_control(int slot, unsigned char value) {
+        _control[slot] = value;
+        if (slot < GROUP_WIDTH) {
+            _control[capacity_slots() + slot] = value;
+        }
+    }
+
+    // Stores an entry in an EMPTY slot.
+    void store(int slot, const K& key, const V& value, unsigned int hash) {
+        set_control(slot, fingerprint(hash));
+        _keys[slot] = key;
+        _values[slot] = value;
+        ++_size;
+    }
+
+    // Inserts key if absent, assuming room for one more entry.
+    int insert_no_grow(const K& key, const V& value, unsigned int hash,
+                       bool& inserted) {
+        int insert_slot = -1;
+        int slot = find_slot(key, hash, insert_slot);
+        inserted = slot < 0;
+        if (inserted) {
+            store(insert_slot, key, value, hash);
+            slot = insert_slot;
+        }
+        return slot;
+    }
+
+    // Whether one more entry would exceed 3/4 load.
+    bool needs_growth(int entries) const {
+        return 4 * entries > 3 * capacity_slots();
+    }
+
+    // Moves every entry into a table with the given number of slots.
+    void rehash(int capacity) {
+        DynamicallySizedArray<unsigned char> old_control(_control);
+        DynamicallySizedArray<K> old_keys(_keys);
+        DynamicallySizedArray<V> old_values(_values);
+        int old_capacity = capacity_slots();
+
+        _control.resize(0);
+        _control.resize(capacity + GROUP_WIDTH);
+        for (int i = 0; i < capacity + GROUP_WIDTH; ++i) {
+            _control[i] = EMPTY;
+        }
+        _keys.resize(0);
+        _keys.resize(capacity);
+        _values.resize(0);
+        _values.resize(capacity);
+        _mask = static_cast<unsigned int>(capacity - 1);
+        _size = 0;
+
+        for (int i = 0; i < old_capacity; ++i) {
+            if (old_control[i] != EMPTY) {
+                unsigned int hash = KeyHash<K>::hash(old_keys[i]);
+                int insert_slot = -1;
+                find_slot(old_keys[i], hash, insert_slot);
+                store(insert_slot, old_keys[i], old_values[i], hash);
+            }
+        }
+    }
+
+  public:
+    // Constructor: an empty map (no slots until the first insert).
+    FlatHashMap() : _control(), _keys(), _values(), _size(0), _mask(0) {}
+
+    // Copy Constructor
+    FlatHashMap(const FlatHashMap& other)
+        : _control(other._control), _keys(other._keys),
+          _values(other._values), _size(other._size), _mask(other._mask) {}
+
+    // Assignment operator
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            _control = other._control;
+            _keys = other._keys;
+            _values = other._values;
+            _size = other._size;
+            _mask = other._mask;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~FlatHashMap() {}
+
+    // Number of entries.
+    int size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    // Number of slots.
+    int capacity() const {
+        return capacity_slots();
+    }
+
+    /**
+     * @brief Grows the table so that n entries fit without rehashing.
+     *
+     * @param n Number of entries to make room for.
+     */
+    void reserve(int n) {
+        int capacity = (capacity_slots() < GROUP_WIDTH) ? GROUP_WIDTH
+                                                         : capacity_slots();
+        while (4 * n > 3 * capacity) {
+            capacity *= 2;
+        }
+        if (capacity != capacity_slots()) {
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * @brief Finds the value stored under key. O(1) expected.
+     *
+     * @return Pointer to the value, or NULL if key is absent.
+     */
+    V* find(const K& key) {
+        if (_size == 0) {
+            return 0;
+        }
+        int insert_slot;
+        int slot = find_slot(key, KeyHash<K>::hash(key), insert_slot);
+        return (slot < 0) ? 0 : &_values[slot];
+    }
+
+    const V* find(const K& key) const {
+        if (_size == 0) {
+            return 0;
+        }
+        int insert_slot;
+        int slot = find_slot(key, KeyHash<K>::hash(key), insert_slot);
+        return (slot < 0) ? 0 : &_values[slot];
+    }
+
+    // Whether key is present.
+    bool contains(const K& key) const {
+        return find(key) != 0;
+    }
+
+    /**
+     * @brief Inserts key with value if key is absent (an existing value is
+     * left unchanged). O(1) expected, amortized over growth.
+     *
+     * @return true if inserted.
+     */
+    bool insert(const K& key, const V& value) {
+        if (needs_growth(_size + 1)) {
+            reserve(_size + 1);
+        }
+        bool inserted;
+        insert_no_grow(key, value, KeyHash<K>::hash(key), inserted);
+        return inserted;
+    }
+
+    // The value under key, inserting V() first if key is absent.
+    V& operator[](const K& key) {
+        if (needs_growth(_size + 1)) {
+            reserve(_size + 1);
+        }
+        bool inserted;
+        int slot = insert_no_grow(key, V(), KeyHash<K>::hash(key), inserted);
+        return _values[slot];
+    }
+
+    /**
+     * @brief Inserts n key-value pairs (as by insert(), in order).
+     *
+     * Reserves room for all of them up front, so the table is rehashed at
+     * most once, and prefetches the home group of the key
+     * PREFETCH_DISTANCE positions ahead, so the cache misses of consecutive
+     * inserts overlap.
+     *
+     * @return The number of keys that were inserted (absent before).
+     */
+    int insert_batch(const K* keys, const V* values, int n) {
+        reserve(_size + n);
+        unsigned int hashes[PREFETCH_DISTANCE];
+        for (int i = 0; i < n && i < PREFETCH_DISTANCE; ++i) {
+            hashes[i] = KeyHash<K>::hash(keys[i]);
+            prefetch(&_control[hashes[i] & _mask]);
+            prefetch(&_keys[hashes[i] & _mask]);
+        }
+        int inserted_count = 0;
+        for (int i = 0; i < n; ++i) {
+            unsigned int hash = hashes[i % PREFETCH_DISTANCE];
+            int ahead = i + PREFETCH_DISTANCE;
+            if (ahead < n) {
+                unsigned int next = KeyHash<K>::hash(keys[ahead]);
+                hashes[ahead % PREFETCH_DISTANCE] = next;
+                prefetch(&_control[next & _mask]);
+                prefetch(&_keys[next & _mask]);
+            }
+            bool inserted;
+            insert_no_grow(keys[i], values[i], hash, inserted);
+            inserted_count += inserted;
+        }
+        return inserted_count;
+    }
+
+    /**
+     * @brief Removes key. The entries after it in its probe run are shifted
+     * back into the hole when that does not move them before their home
+     * slot, so no tombstone is left. O(1) expected.
+     *
+     * @return true if key was present.
+     */
+    bool erase(const K& key) {
+        if (_size == 0) {
+            return false;
+        }
+        int insert_slot;
+        int found = find_slot(key, KeyHash<K>::hash(key), insert_slot);
+        if (found < 0) {
+            return false;
+        }
+        unsigned int hole = static_cast<unsigned int>(found);
+        unsigned int next = hole;
+        for (;;) {
+            next = (next + 1) & _mask;
+            if (_control[next] == EMPTY) {
+                break;
+            }
+            unsigned int home = KeyHash<K>::hash(_keys[next]) & _mask;
+            // The entry may fill the hole if the hole is on its probe run,
+            // i.e. no further from next than its home is.
+            if (((next - home) & _mask) >= ((next - hole) & _mask)) {
+                set_control(static_cast<int>(hole), _control[next]);
+                _keys[hole] = _keys[next];
+                _values[hole] = _values[next];
+                hole = next;
+            }
+        }
+        set_control(static_cast<int>(hole), EMPTY);
+        _keys[hole] = K();
+        _values[hole] = V();
+        --_size;
+        return true;
+    }
+
+    // Removes every entry and releases the table.
+    void clear() {
+        _control = DynamicallySizedArray<unsigned char>();
+        _keys = DynamicallySizedArray<K>();
+        _values = DynamicallySizedArray<V>();
+        _size = 0;
+        _mask = 0;
+    }
+};
+
+#endif // FLAT_HASH_MAP_H
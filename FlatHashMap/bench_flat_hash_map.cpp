@@ -0,0 +1,142 @@
+// bench_flat_hash_map.cpp
+// Benchmark: FlatHashMap against Treap on the same insert/find/erase traces.
+//
+// N random keys from [0, 2N) are inserted one by one (duplicates are kept
+// out by both containers), then into a fresh FlatHashMap with a single
+// insert_batch(). QUERIES lookups run for keys known to be present (hits)
+// and for uniform keys (about 40% hits). Finally the first half of the
+// insert trace is erased, and the mixed lookups are run again to show that
+// erase leaves no tombstones behind.
+//
+// Usage: ./bin/bench_flat_hash_map [N ...]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "FlatHashMap.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+
+typedef Treap<int, int> TreeMap;
+typedef FlatHashMap<int, int> HashMap;
+typedef TreapNode<int, int> Node;
+
+static void report(char const* name, int ops, double t_tree, double t_hash,
+                   long sum_tree, long sum_hash) {
+    if (sum_tree != sum_hash) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    std::printf("  %-14s treap %7.2f Mop/s   flat hash %8.2f Mop/s   speedup "
+                "%.2fx\n",
+                name, ops / t_tree / 1e6, ops / t_hash / 1e6, t_tree / t_hash);
+}
+
+static long tree_lookups(const TreeMap& tree, const int* queries,
+                         double& seconds) {
+    long sum = 0;
+    clock_t start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = tree.find(queries[i]);
+        sum += (found == 0) ? -1 : found->value;
+    }
+    seconds = seconds_since(start);
+    return sum;
+}
+
+static long hash_lookups(const HashMap& map, const int* queries,
+                         double& seconds) {
+    long sum = 0;
+    clock_t start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        const int* found = map.find(queries[i]);
+        sum += (found == 0) ? -1 : *found;
+    }
+    seconds = seconds_since(start);
+    return sum;
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    int* keys = new int[n];
+    int* values = new int[n];
+    for (int i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(rng.next() % key_range);
+        values[i] = i;
+    }
+
+    TreeMap tree;
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        tree.insert(keys[i], values[i]);
+    }
+    double t_tree = seconds_since(start);
+    HashMap map;
+    start = clock();
+    for (int i = 0; i < n; ++i) {
+        map.insert(keys[i], values[i]);
+    }
+    double t_hash = seconds_since(start);
+
+    std::printf("N = %d (%d keys, %d slots)\n", n, map.size(),
+                map.capacity());
+    report("insert", n, t_tree, t_hash, tree.size(), map.size());
+
+    HashMap batched;
+    start = clock();
+    batched.insert_batch(keys, values, n);
+    double t_batch = seconds_since(start);
+    report("insert_batch", n, t_tree, t_batch, tree.size(), batched.size());
+
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = keys[rng.next() % n];
+    }
+    long sum_tree = tree_lookups(tree, queries, t_tree);
+    long sum_hash = hash_lookups(map, queries, t_hash);
+    report("find (hits)", QUERIES, t_tree, t_hash, sum_tree, sum_hash);
+
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+    sum_tree = tree_lookups(tree, queries, t_tree);
+    sum_hash = hash_lookups(map, queries, t_hash);
+    report("find (mixed)", QUERIES, t_tree, t_hash, sum_tree, sum_hash);
+
+    int half = n / 2;
+    start = clock();
+    for (int i = 0; i < half; ++i) {
+        Node* found = tree.find(keys[i]);
+        if (found != 0) {
+            tree.erase(found);
+        }
+    }
+    t_tree = seconds_since(start);
+    start = clock();
+    for (int i = 0; i < half; ++i) {
+        map.erase(keys[i]);
+    }
+    t_hash = seconds_since(start);
+    report("erase", half, t_tree, t_hash, tree.size(), map.size());
+
+    sum_tree = tree_lookups(tree, queries, t_tree);
+    sum_hash = hash_lookups(map, queries, t_hash);
+    report("find (erased)", QUERIES, t_tree, t_hash, sum_tree, sum_hash);
+
+    delete[] keys;
+    delete[] values;
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef HASH_MIX_H
+#define HASH_MIX_H
+
+// Integer hashing shared by the hash tables and the treap priorities.
+
+// 32-bit finalizer (bijective), spreads the key bits over the whole word.
+inline unsigned int hash_mix32(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * KeyHash
+ * static unsigned int hash(const K&) for TreapHashIndex and FlatHashMap.
+ * Specialize it for other key types; equal keys must hash equally.
+ */
+template <typename K> struct KeyHash;
+
+template <> struct KeyHash<int> {
+    static unsigned int hash(int key) {
+        return hash_mix32(static_cast<unsigned int>(key));
+    }
+};
+
+template <> struct KeyHash<unsigned int> {
+    static unsigned int hash(unsigned int key) {
+        return hash_mix32(key);
+    }
+};
+
+template <> struct KeyHash<long> {
+    static unsigned int hash(long key) {
+        unsigned long bits = static_cast<unsigned long>(key);
+        return hash_mix32(static_cast<unsigned int>(
+            bits ^ (bits >> (4 * sizeof(unsigned long)))));
+    }
+};
+
+template <> struct KeyHash<unsigned long> {
+    static unsigned int hash(unsigned long key) {
+        return hash_mix32(static_cast<unsigned int>(
+            key ^ (key >> (4 * sizeof(unsigned long)))));
+    }
+};
+
+#endif // HASH_MIX_H
@@ -1,173 +1,345 @@
 #ifndef HEAP_H
 #define HEAP_H
 #include "DynamicallySizedArray.h"
+#include "HeapCompare.h"
+#include <cstddef>
 
-template <typename T> struct Heap2 {
+/**
+ * Heap2
+ * A d-ary heap. Arity is the number of children per node (2, 4 or 8); the
+ * default of 2 is the classic binary heap. Compare decides which element is
+ * on top: compare(a, b) is true when a comes out before b. The default
+ * HeapLess<T> gives a min-heap, HeapGreater<T> a max-heap.
+ *
+ * Layout: logical index i lives at _array[_shift + i]. The children of i are
+ * Arity*i + 1 .. Arity*i + Arity, and _shift (0 .. Arity-1) is picked after
+ * every reallocation so that each sibling group starts on a boundary of
+ * Arity * sizeof(T) bytes (capped at a 64-byte cache line). A sift step then
+ * touches a single cache line for all children of a node. The Arity - 1
+ * spare slots needed for the shift are kept in _array at all times.
+ */
+template <typename T, int Arity = 2, typename Compare = HeapLess<T> >
+struct Heap2 {
   private:
     // Import DSA for DRY.
     DynamicallySizedArray<T> _array;
+    Compare _compare; // Heap order; _compare(a, b) means a is above b.
+    int _shift;     // Physical index of the root.
+    T const* _base; // Buffer _shift was computed for.
+
+    static const int CACHE_LINE = 64;
+
+    // Logical element access.
+    T& elem(int index) {
+        return _array[_shift + index];
+    }
+    T const& elem(int index) const {
+        return _array[_shift + index];
+    }
+
+    /**
+     * @brief Re-picks _shift if the underlying buffer has moved (the DSA
+     * reallocates on growth, shrink and copy), moving the elements to match.
+     *
+     * This is O(n) but only runs right after an O(n) reallocation.
+     */
+    void realign() {
+        T const* base = &_array[0];
+        if (base == _base) {
+            return;
+        }
+        _base = base;
+
+        std::size_t group = Arity * sizeof(T);
+        if (group > static_cast<std::size_t>(CACHE_LINE)) {
+            group = CACHE_LINE;
+        }
+        // Fall back to index alignment if no shift hits a byte boundary.
+        int new_shift = Arity - 1;
+        for (int s = 0; s < Arity; ++s) {
+            std::size_t first_child =
+                reinterpret_cast<std::size_t>(base + s + 1);
+            if (first_child % group == 0) {
+                new_shift = s;
+                break;
+            }
+        }
+        if (new_shift == _shift) {
+            return;
+        }
+
+        int n = size();
+        if (new_shift < _shift) {
+            for (int i = 0; i < n; ++i) {
+                _array[new_shift + i] = _array[_shift + i];
+            }
+        } else {
+            for (int i = n - 1; i >= 0; --i) {
+                _array[new_shift + i] = _array[_shift + i];
+            }
+        }
+        _shift = new_shift;
+    }
 
     /**
-     * @brief Heapify the array. This is used in the constructor that takes an
-     * array as input.
+     * @brief Heapify the array (Floyd's bottom-up build). This is used by the
+     * range constructor, assign() and push_batch().
      *
      * We start from the last non-leaf node and sift down each node until we
      * reach the root. This will ensure that the heap property is maintained for
-     * all nodes in the heap.
+     * all nodes in the heap. The total work is O(n), since most nodes sit near
+     * the bottom and only sift a few levels.
      */
-    void heapify(int index) {
-        for (int i = (_array.size() / 2) - 1; i > -1; --i) {
-            sift_down(i); // Sift down each node until we reach the root
+    void heapify() {
+        if (size() < 2) {
+            return;
+        }
+        for (int i = (size() - 2) / Arity; i > -1; --i) {
+            T value = elem(i);
+            sift_down(i, value); // Sift down each node until we reach the root
         }
     }
 
     /**
-     * @brief Helper function that swaps the values at the given indices in the
-     * array.
+     * @brief Appends n values to the end of the heap without restoring the
+     * heap property. The array is grown once up front so the DSA reallocates
+     * at most one time.
      *
-     * @param index1 Index of the first value to swap.
-     * @param index2 Index of the second value to swap.
+     * @param first Pointer to the first value to append.
+     * @param n Number of values to append.
      */
-    void swap_array_values(int index1, int index2) {
-        T tempVar = _array[index1];
-        _array[index1] = _array[index2];
-        _array[index2] = tempVar;
+    void append(T const* first, int n) {
+        int old_size = size();
+        _array.resize(_array.size() + n);
+        realign();
+        for (int i = 0; i < n; ++i) {
+            elem(old_size + i) = first[i];
+        }
     }
 
     /**
-     * @brief Sift up the element at the given index to maintain the heap
+     * @brief Sift up a value from the given hole to maintain the heap
      * property. This is used in the push() operation.
      *
-     * We compare the element with its parent and swap if it's smaller. We
-     * repeat this process until we reach the root or the element is no longer
-     * smaller than its parent.
+     * Instead of swapping at every level, parents larger than the value are
+     * moved down into the hole and the value is written once at the end.
      *
-     * @param elem_index Index of the element to sift up.
+     * @param hole Index of the empty slot to start from.
+     * @param value The value that belongs in the hole.
      */
-    void sift_up(int elem_index) {
-        while (elem_index > 0) {
-            int parent_index = (elem_index - 1) / 2;
-            if (_array[elem_index] < _array[parent_index]) {
-                swap_array_values(elem_index, parent_index);
-                elem_index = parent_index;
+    void sift_up(int hole, T const& value) {
+        while (hole > 0) {
+            int parent_index = (hole - 1) / Arity;
+            if (_compare(value, elem(parent_index))) {
+                elem(hole) = elem(parent_index);
+                hole = parent_index;
             } else {
-                return;
+                break;
             }
         }
+        elem(hole) = value;
     }
 
     /**
-     * @brief Sift down the element at the given index to maintain the heap
+     * @brief Sift down a value from the given hole to maintain the heap
      * property. This is used in the pop() operation.
      *
-     * We compare the element with its children and swap with the smaller child
-     * if it's larger. We repeat this process until we reach a leaf or the
-     * element is no longer larger than its children.
+     * At every level the smallest of the (up to Arity) children is found; if
+     * it is smaller than the value it is moved up into the hole. The value is
+     * written once when it no longer is larger than its children.
      *
-     * @param elem_index Index of the element to sift down.
+     * @param hole Index of the empty slot to start from.
+     * @param value The value that belongs in the hole.
      */
-    void sift_down(int elem_index) {
-        int array_size = _array.size();
+    void sift_down(int hole, T const& value) {
+        int array_size = size();
         while (true) {
-            int left_child_index = 2 * elem_index + 1;
-            int right_child_index = left_child_index + 1;
-            int smallest = elem_index;
-
-            if (left_child_index < array_size &&
-                _array[left_child_index] < _array[smallest]) {
-                smallest = left_child_index;
+            int first_child = Arity * hole + 1;
+            if (first_child >= array_size) {
+                break;
             }
-            if (right_child_index < array_size &&
-                _array[right_child_index] < _array[smallest]) {
-                smallest = right_child_index;
+            int last_child = first_child + Arity;
+            if (last_child > array_size) {
+                last_child = array_size;
             }
 
-            if (smallest == elem_index) {
-                break;
+            int smallest = first_child;
+            for (int c = first_child + 1; c < last_child; ++c) {
+                if (_compare(elem(c), elem(smallest))) {
+                    smallest = c;
+                }
             }
 
-            swap_array_values(elem_index, smallest);
-            elem_index = smallest;
+            if (!_compare(elem(smallest), value)) {
+                break;
+            }
+            elem(hole) = elem(smallest);
+            hole = smallest;
         }
+        elem(hole) = value;
     }
 
   public:
     // Constructor
-    Heap2() : _array() {}
+    Heap2() : _array(), _compare(), _shift(Arity - 1), _base(0) {
+        _array.resize(Arity - 1);
+        realign();
+    }
+
+    // Constructor with a (possibly stateful) comparator
+    explicit Heap2(Compare const& compare)
+        : _array(), _compare(compare), _shift(Arity - 1), _base(0) {
+        _array.resize(Arity - 1);
+        realign();
+    }
 
     // Copy Constructor
-    Heap2(Heap2 const& other) : _array(other._array) {}
+    Heap2(Heap2 const& other)
+        : _array(other._array), _compare(other._compare),
+          _shift(other._shift), _base(0) {
+        realign();
+    }
 
     // Assignment operator
     Heap2& operator=(Heap2 const& other) {
         if (this != &other) {
             _array = other._array;
+            _compare = other._compare;
+            _shift = other._shift;
+            _base = 0;
+            realign();
         }
         return *this;
     }
 
+    /**
+     * @brief Builds a heap from n values in O(n) using Floyd's method instead
+     * of n separate push() calls.
+     *
+     * @param first Pointer to the first of the n values.
+     * @param n Number of values (>= 0).
+     */
+    Heap2(T const* first, int n, Compare const& compare = Compare())
+        : _array(), _compare(compare), _shift(Arity - 1), _base(0) {
+        _array.resize(Arity - 1);
+        append(first, n);
+        heapify();
+    }
+
     // Desctructor
     ~Heap2() {} // Pretty redundant here, but included for assignment
 
     /**
      * @brief Inserts an element into the heap.
      *
-     * We push the element to the end of the array and then sift it up to
-     * maintain the heap property.
+     * We grow the array by one slot and then sift the value up from the new
+     * last position to maintain the heap property.
      *
      * @param value The value to insert into the heap.
      */
     void push(T const& value) {
         _array.push_back(value);
-        sift_up(_array.size() - 1);
+        realign();
+        sift_up(size() - 1, value);
     }
 
     /**
-     * @brief Removes the smallest element from the heap.
+     * @brief Replaces the contents of the heap with n values, built in O(n)
+     * using Floyd's method.
      *
-     * We swap the root with the last element and pop the last element (which is
-     * the smallest). Then we sift down the new root to maintain the heap
-     * property.
+     * @param first Pointer to the first of the n values.
+     * @param n Number of values (>= 0).
+     */
+    void assign(T const* first, int n) {
+        _array.resize(Arity - 1);
+        append(first, n);
+        heapify();
+    }
+
+    /**
+     * @brief Inserts n values into the heap at once.
+     *
+     * The values are appended in one go; then either each one is sifted up
+     * (about n * depth steps in the worst case) or the whole array is
+     * re-heapified (about 2 * size steps), whichever is cheaper. Small batches
+     * into a large heap sift up, large batches rebuild.
+     *
+     * @param first Pointer to the first of the n values.
+     * @param n Number of values (>= 0).
+     */
+    void push_batch(T const* first, int n) {
+        int old_size = size();
+        append(first, n);
+
+        int depth = 0; // Levels in the resulting heap.
+        for (int reach = size(); reach > 0; reach /= Arity) {
+            ++depth;
+        }
+        if (static_cast<long>(n) * depth < 2L * size()) {
+            for (int i = old_size; i < size(); ++i) {
+                T value = elem(i);
+                sift_up(i, value);
+            }
+        } else {
+            heapify();
+        }
+    }
+
+    /**
+     * @brief Removes the top (by default the smallest) element from the heap.
+     *
+     * We take the root out, drop the last slot and sift the last element
+     * down from the root hole to maintain the heap property.
      *
      * @return The smallest element that was removed from the heap.
      */
     T pop() {
-        T minVal = _array[0]; // Store the minimum value to return later
-        // If there's only one element, we can just pop it and return
-        if (_array.size() == 1) {
-            _array.pop_back();
-            return minVal;
+        T minVal = elem(0); // Store the minimum value to return later
+        T last = elem(size() - 1); // Last element is moved into the root hole
+        _array.pop_back();
+        realign();
+        if (size() > 0) {
+            sift_down(0, last); // Restore the heap property from the root
         }
-
-        T last = _array.back(); // Store last element to move to root after pop
-        _array.pop_back();      // Remove the last element from the array
-        _array[0] = last;       // Move the last element to the root
-        sift_down(0);  // Sift down the new root to maintain the heap property
         return minVal; // Finally, return the min value that we poppped
     }
 
     /**
-     * @brief Provides access to the smallest element in the heap.
+     * @brief Replaces the top element with value in a single sift instead of
+     * a pop() followed by a push(). O(log n).
+     *
+     * @param value The value that takes the place of the top element.
+     *
+     * @return The top element that was replaced.
+     */
+    T replace_top(T const& value) {
+        T topVal = elem(0);
+        sift_down(0, value);
+        return topVal;
+    }
+
+    /**
+     * @brief Provides access to the top (by default the smallest) element.
      *
      * We simply return the root of the heap, which is the smallest element.
      *
      * @return The smallest element in the heap.
      */
     T const& peek() const {
-        return _array[0];
+        return elem(0);
     }
 
     /**
      * @brief Provides the size of the heap.
      *
-     * We return the size of the underlying array, which is the number of
-     * elements in the heap.
+     * We return the size of the underlying array minus the spare alignment
+     * slots, which is the number of elements in the heap.
      *
      * @return The size of the heap.
      */
     int size() const {
-        return _array.size();
+        return _array.size() - (Arity - 1);
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,21 @@
+#ifndef HEAP_COMPARE_H
+#define HEAP_COMPARE_H
+
+// Comparators for the heap templates. A comparator is called as
+// compare(a, b) and returns true when a must come out of the heap before b.
+
+// Min-heap order (the default): uses T's operator<.
+template <typename T> struct HeapLess {
+    bool operator()(T const& a, T const& b) const {
+        return a < b;
+    }
+};
+
+// Max-heap order without negating keys: still only needs T's operator<.
+template <typename T> struct HeapGreater {
+    bool operator()(T const& a, T const& b) const {
+        return b < a;
+    }
+};
+
+#endif // HEAP_COMPARE_H
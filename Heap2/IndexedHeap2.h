@@ -0,0 +1,254 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+/**
+ * IndexedHeap2
+ * An addressable binary min-heap. push() returns a stable int handle that
+ * can later be used to change the element's priority or remove it, so callers
+ * no longer have to push duplicates and skip stale entries on pop.
+ *
+ * Invariants:
+ *  - _heap holds (value, handle) entries in level order with the min-heap
+ *    property on value.
+ *  - For every live handle h: _heap[_pos[h]].handle == h.
+ *  - For every free handle h: _pos[h] == -1 and h is in _free_handles.
+ */
+template <typename T> struct IndexedHeap2 {
+  private:
+    struct Entry {
+        T value;
+        int handle;
+    };
+
+    // Import DSA for DRY.
+    DynamicallySizedArray<Entry> _heap;
+    DynamicallySizedArray<int> _pos; // handle -> index in _heap, or -1.
+    DynamicallySizedArray<int> _free_handles; // Handles ready for reuse.
+
+    // Writes the entry into slot index and records its new position.
+    void place(int index, Entry const& entry) {
+        _heap[index] = entry;
+        _pos[entry.handle] = index;
+    }
+
+    /**
+     * @brief Sift an entry up from the given hole to maintain the heap
+     * property, updating the position map for every entry that moves.
+     *
+     * @param hole Index of the slot to start from.
+     * @param entry The entry that belongs in the hole.
+     */
+    void sift_up(int hole, Entry const& entry) {
+        while (hole > 0) {
+            int parent_index = (hole - 1) / 2;
+            if (entry.value < _heap[parent_index].value) {
+                place(hole, _heap[parent_index]);
+                hole = parent_index;
+            } else {
+                break;
+            }
+        }
+        place(hole, entry);
+    }
+
+    /**
+     * @brief Sift an entry down from the given hole to maintain the heap
+     * property, updating the position map for every entry that moves.
+     *
+     * @param hole Index of the slot to start from.
+     * @param entry The entry that belongs in the hole.
+     */
+    void sift_down(int hole, Entry const& entry) {
+        int array_size = _heap.size();
+        while (true) {
+            int smallest = 2 * hole + 1;
+            if (smallest >= array_size) {
+                break;
+            }
+            int right_child_index = smallest + 1;
+            if (right_child_index < array_size &&
+                _heap[right_child_index].value < _heap[smallest].value) {
+                smallest = right_child_index;
+            }
+            if (!(_heap[smallest].value < entry.value)) {
+                break;
+            }
+            place(hole, _heap[smallest]);
+            hole = smallest;
+        }
+        place(hole, entry);
+    }
+
+    /**
+     * @brief Removes the entry at the given index, moving the last entry into
+     * its place and sifting it in whichever direction restores the heap.
+     *
+     * @param index Index of the entry to remove.
+     */
+    void remove_at(int index) {
+        int handle = _heap[index].handle;
+        _pos[handle] = -1;
+        _free_handles.push_back(handle);
+
+        Entry last = _heap.back();
+        _heap.pop_back();
+        if (index == _heap.size()) {
+            return; // The removed entry was the last one.
+        }
+        if (index > 0 && last.value < _heap[(index - 1) / 2].value) {
+            sift_up(index, last);
+        } else {
+            sift_down(index, last);
+        }
+    }
+
+  public:
+    // Constructor
+    IndexedHeap2() : _heap(), _pos(), _free_handles() {}
+
+    // Copy Constructor: handles stay valid in the copy.
+    IndexedHeap2(IndexedHeap2 const& other)
+        : _heap(other._heap), _pos(other._pos),
+          _free_handles(other._free_handles) {}
+
+    // Assignment operator
+    IndexedHeap2& operator=(IndexedHeap2 const& other) {
+        if (this != &other) {
+            _heap = other._heap;
+            _pos = other._pos;
+            _free_handles = other._free_handles;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~IndexedHeap2() {}
+
+    /**
+     * @brief Inserts an element into the heap. O(log n).
+     *
+     * @param value The value to insert into the heap.
+     *
+     * @return A handle for the element, valid until it is popped or erased.
+     * Handles of removed elements are reused by later pushes.
+     */
+    int push(T const& value) {
+        Entry entry;
+        entry.value = value;
+        if (_free_handles.empty()) {
+            entry.handle = _pos.size();
+            _pos.push_back(-1);
+        } else {
+            entry.handle = _free_handles.back();
+            _free_handles.pop_back();
+        }
+        _heap.push_back(entry);
+        sift_up(_heap.size() - 1, entry);
+        return entry.handle;
+    }
+
+    /**
+     * @brief Removes the smallest element from the heap. O(log n).
+     *
+     * @return The smallest element that was removed from the heap.
+     */
+    T pop() {
+        T minVal = _heap[0].value;
+        remove_at(0);
+        return minVal;
+    }
+
+    /**
+     * @brief Provides access to the smallest element in the heap. O(1).
+     *
+     * @return The smallest element in the heap.
+     */
+    T const& peek() const {
+        return _heap[0].value;
+    }
+
+    /**
+     * @brief Provides the handle of the smallest element in the heap. O(1).
+     *
+     * @return The handle of the smallest element in the heap.
+     */
+    int peek_handle() const {
+        return _heap[0].handle;
+    }
+
+    /**
+     * @brief Provides the size of the heap. O(1).
+     *
+     * @return The number of elements in the heap.
+     */
+    int size() const {
+        return _heap.size();
+    }
+
+    /**
+     * @brief Checks whether a handle refers to an element in the heap. O(1).
+     *
+     * @param handle The handle to check.
+     *
+     * @return true if the handle is live.
+     */
+    bool contains(int handle) const {
+        return handle >= 0 && handle < _pos.size() && _pos[handle] != -1;
+    }
+
+    /**
+     * @brief Provides the current value of a live handle. O(1).
+     *
+     * @param handle A live handle returned by push().
+     *
+     * @return The element's value.
+     */
+    T const& value(int handle) const {
+        assert(contains(handle));
+        return _heap[_pos[handle]].value;
+    }
+
+    /**
+     * @brief Lowers the value of an element and sifts it up. O(log n).
+     *
+     * @param handle A live handle returned by push().
+     * @param value The new value; must not be greater than the current one.
+     */
+    void decrease_key(int handle, T const& value) {
+        assert(contains(handle));
+        int index = _pos[handle];
+        assert(!(_heap[index].value < value));
+        Entry entry = _heap[index];
+        entry.value = value;
+        sift_up(index, entry);
+    }
+
+    /**
+     * @brief Raises the value of an element and sifts it down. O(log n).
+     *
+     * @param handle A live handle returned by push().
+     * @param value The new value; must not be less than the current one.
+     */
+    void increase_key(int handle, T const& value) {
+        assert(contains(handle));
+        int index = _pos[handle];
+        assert(!(value < _heap[index].value));
+        Entry entry = _heap[index];
+        entry.value = value;
+        sift_down(index, entry);
+    }
+
+    /**
+     * @brief Removes an arbitrary element from the heap. O(log n).
+     *
+     * @param handle A live handle returned by push(); it becomes free.
+     */
+    void erase(int handle) {
+        assert(contains(handle));
+        remove_at(_pos[handle]);
+    }
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef MIN_MAX_HEAP_H
+#define MIN_MAX_HEAP_H
+#include "DynamicallySizedArray.h"
+#include "HeapCompare.h"
+#include <cassert>
+
+/**
+ * MinMaxHeap
+ * A double-ended priority queue (Atkinson et al. min-max heap) on a single
+ * level-ordered array, replacing a min-heap + max-heap pair.
+ *
+ * Nodes on even levels (the root is level 0) are "min" nodes: no larger
+ * than anything in their subtree. Nodes on odd levels are "max" nodes: no
+ * smaller than anything in their subtree. So the minimum is the root and the
+ * maximum is one of the root's children.
+ *
+ * "Smaller" is defined by Compare: compare(a, b) is true when a < b.
+ */
+template <typename T, typename Compare = HeapLess<T> > struct MinMaxHeap {
+  private:
+    // Import DSA for DRY.
+    DynamicallySizedArray<T> _array;
+    Compare _compare;
+
+    // Whether index lies on a min (even) level.
+    static bool is_min_level(int index) {
+        int level = 0;
+        for (int i = index + 1; i > 1; i >>= 1) {
+            ++level;
+        }
+        return (level & 1) == 0;
+    }
+
+    // Ordering helper: on a min level "better" means smaller, on a max level
+    // it means larger.
+    bool better(T const& a, T const& b, bool min_level) const {
+        return min_level ? _compare(a, b) : _compare(b, a);
+    }
+
+    /**
+     * @brief Helper function that swaps the values at the given indices in the
+     * array.
+     *
+     * @param index1 Index of the first value to swap.
+     * @param index2 Index of the second value to swap.
+     */
+    void swap_array_values(int index1, int index2) {
+        T tempVar = _array[index1];
+        _array[index1] = _array[index2];
+        _array[index2] = tempVar;
+    }
+
+    /**
+     * @brief Moves the element at index up through its grandparents, which
+     * are on the same kind of level, while it is better than them.
+     *
+     * @param index Index of the element to bubble up.
+     * @param min_level Whether index is on a min level.
+     */
+    void bubble_up_grandparents(int index, bool min_level) {
+        while (index > 2) {
+            int grandparent = ((index - 1) / 2 - 1) / 2;
+            if (!better(_array[index], _array[grandparent], min_level)) {
+                return;
+            }
+            swap_array_values(index, grandparent);
+            index = grandparent;
+        }
+    }
+
+    /**
+     * @brief Restores the min-max property after appending at index.
+     *
+     * If the new element is on the wrong side of its parent it is swapped
+     * with it first; then it bubbles up through the grandparents of
+     * whichever kind of level it now sits on.
+     *
+     * @param index Index of the newly appended element.
+     */
+    void bubble_up(int index) {
+        if (index == 0) {
+            return;
+        }
+        bool min_level = is_min_level(index);
+        int parent = (index - 1) / 2;
+        if (better(_array[index], _array[parent], !min_level)) {
+            // Better than its parent on the parent's own terms: belongs on the
+            // parent's kind of level.
+            swap_array_values(index, parent);
+            bubble_up_grandparents(parent, !min_level);
+        } else {
+            bubble_up_grandparents(index, min_level);
+        }
+    }
+
+    /**
+     * @brief Restores the min-max property below index after its value has
+     * been replaced (used by the pop operations).
+     *
+     * At each step the best of the children and grandchildren is found. If it
+     * is a grandchild and better than the element, they swap; the element may
+     * then need to swap with the grandchild's parent (a node on the opposite
+     * kind of level) and the walk continues from the grandchild. If it is a
+     * child, a single swap finishes the job.
+     *
+     * @param index Index of the element to trickle down.
+     */
+    void trickle_down(int index) {
+        bool min_level = is_min_level(index);
+        int array_size = _array.size();
+        while (true) {
+            int first_child = 2 * index + 1;
+            if (first_child >= array_size) {
+                return;
+            }
+
+            int best = first_child;
+            bool best_is_grandchild = false;
+            if (first_child + 1 < array_size &&
+                better(_array[first_child + 1], _array[best], min_level)) {
+                best = first_child + 1;
+            }
+            int first_grandchild = 2 * first_child + 1;
+            for (int g = first_grandchild;
+                 g < first_grandchild + 4 && g < array_size; ++g) {
+                if (better(_array[g], _array[best], min_level)) {
+                    best = g;
+                    best_is_grandchild = true;
+                }
+            }
+
+            if (!better(_array[best], _array[index], min_level)) {
+                return;
+            }
+            swap_array_values(index, best);
+            if (!best_is_grandchild) {
+                return;
+            }
+            int parent = (best - 1) / 2;
+            if (better(_array[parent], _array[best], min_level)) {
+                swap_array_values(best, parent);
+            }
+            index = best;
+        }
+    }
+
+    /**
+     * @brief Removes the element at index (the root or one of its children)
+     * by moving the last element into its place.
+     *
+     * @param index Index of the element to remove.
+     */
+    void remove_at(int index) {
+        int last = _array.size() - 1;
+        if (index != last) {
+            _array[index] = _array[last];
+        }
+        _array.pop_back();
+        if (index < _array.size()) {
+            trickle_down(index);
+        }
+    }
+
+    // Index of the maximum element (size() must be > 0).
+    int max_index() const {
+        if (_array.size() == 1) {
+            return 0;
+        }
+        if (_array.size() == 2 || !_compare(_array[1], _array[2])) {
+            return 1;
+        }
+        return 2;
+    }
+
+  public:
+    // Constructor
+    MinMaxHeap() : _array(), _compare() {}
+
+    // Constructor with a (possibly stateful) comparator
+    explicit MinMaxHeap(Compare const& compare)
+        : _array(), _compare(compare) {}
+
+    // Copy Constructor
+    MinMaxHeap(MinMaxHeap const& other)
+        : _array(other._array), _compare(other._compare) {}
+
+    // Assignment operator
+    MinMaxHeap& operator=(MinMaxHeap const& other) {
+        if (this != &other) {
+            _array = other._array;
+            _compare = other._compare;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~MinMaxHeap() {}
+
+    /**
+     * @brief Inserts an element into the heap. O(log n).
+     *
+     * @param value The value to insert into the heap.
+     */
+    void push(T const& value) {
+        _array.push_back(value);
+        bubble_up(_array.size() - 1);
+    }
+
+    /**
+     * @brief Provides access to the smallest element (the root). O(1).
+     *
+     * @return The smallest element in the heap.
+     */
+    T const& peek_min() const {
+        assert(_array.size() > 0);
+        return _array[0];
+    }
+
+    /**
+     * @brief Provides access to the largest element (a child of the root).
+     * O(1).
+     *
+     * @return The largest element in the heap.
+     */
+    T const& peek_max() const {
+        assert(_array.size() > 0);
+        return _array[max_index()];
+    }
+
+    /**
+     * @brief Removes the smallest element from the heap. O(log n).
+     *
+     * @return The smallest element that was removed from the heap.
+     */
+    T pop_min() {
+        assert(_array.size() > 0);
+        T minVal = _array[0];
+        remove_at(0);
+        return minVal;
+    }
+
+    /**
+     * @brief Removes the largest element from the heap. O(log n).
+     *
+     * @return The largest element that was removed from the heap.
+     */
+    T pop_max() {
+        assert(_array.size() > 0);
+        int index = max_index();
+        T maxVal = _array[index];
+        remove_at(index);
+        return maxVal;
+    }
+
+    /**
+     * @brief Provides the size of the heap. O(1).
+     *
+     * @return The number of elements in the heap.
+     */
+    int size() const {
+        return _array.size();
+    }
+};
+
+#endif // MIN_MAX_HEAP_H
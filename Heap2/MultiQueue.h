@@ -0,0 +1,222 @@
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+#include "Heap2.h"
+#include <cassert>
+#include <pthread.h>
+
+/**
+ * MultiQueue
+ * A relaxed concurrent priority queue (Rihani, Sanders & Dementiev) made of
+ * c * P independent Heap2 shards, each guarded by its own mutex that is only
+ * ever try-locked on the fast path.
+ *
+ *  - push() puts the value into a random shard it manages to lock.
+ *  - try_pop() try-locks two random shards and pops the better of their two
+ *    tops.
+ *
+ * Pops are not strictly in order: the popped value is near the top with high
+ * probability (expected rank error O(c * P)), in exchange for throughput
+ * that scales with the number of threads instead of serializing on one lock.
+ *
+ * Every thread keeps its own random state (any non-zero unsigned int) and
+ * passes it to push()/try_pop(), so no shared state is touched to pick
+ * shards. Needs -pthread.
+ */
+template <typename T, typename Compare = HeapLess<T> > struct MultiQueue {
+  private:
+    static const int CACHE_LINE = 64;
+
+    struct Shard {
+        pthread_mutex_t lock;
+        Heap2<T, 2, Compare> heap;
+        char pad[CACHE_LINE]; // Keeps neighbouring locks off this line.
+    };
+
+    Shard* _shards;
+    int _shard_count;
+    Compare _compare;
+    volatile int _size; // Updated with atomic adds; approximate when read.
+
+    // Not copyable: shards hold mutexes.
+    MultiQueue(MultiQueue const&);
+    MultiQueue& operator=(MultiQueue const&);
+
+    // xorshift step on the caller's random state.
+    static unsigned int next_random(unsigned int& seed) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    /**
+     * @brief Pops from whichever of the two locked shards has the better top.
+     *
+     * @param a First locked shard.
+     * @param b Second locked shard (may be NULL).
+     * @param out Receives the popped value.
+     * @param sequence Pop counter to take a stamp from (may be NULL).
+     * @param stamp Receives the stamp.
+     *
+     * @return true if one of the shards was non-empty.
+     */
+    bool pop_better(Shard* a, Shard* b, T& out, volatile int* sequence,
+                    int* stamp) {
+        Shard* best = 0;
+        if (a->heap.size() > 0) {
+            best = a;
+        }
+        if (b != 0 && b->heap.size() > 0 &&
+            (best == 0 || _compare(b->heap.peek(), best->heap.peek()))) {
+            best = b;
+        }
+        if (best == 0) {
+            return false;
+        }
+        out = best->heap.pop();
+        if (sequence != 0) {
+            *stamp = __sync_fetch_and_add(sequence, 1);
+        }
+        __sync_fetch_and_sub(&_size, 1);
+        return true;
+    }
+
+    // try_pop(), optionally stamping the pop (see the public overloads).
+    bool pop_stamped(T& out, unsigned int& seed, volatile int* sequence,
+                     int* stamp) {
+        while (__sync_fetch_and_add(&_size, 0) > 0) {
+            int i = next_random(seed) % _shard_count;
+            int j = next_random(seed) % (_shard_count - 1);
+            if (j >= i) {
+                ++j; // Two distinct shards.
+            }
+            Shard* a = &_shards[i];
+            Shard* b = &_shards[j];
+            if (pthread_mutex_trylock(&a->lock) != 0) {
+                continue;
+            }
+            if (pthread_mutex_trylock(&b->lock) != 0) {
+                b = 0; // Fall back to a single choice rather than spin.
+            }
+            bool popped = pop_better(a, b, out, sequence, stamp);
+            if (b != 0) {
+                pthread_mutex_unlock(&b->lock);
+            }
+            pthread_mutex_unlock(&a->lock);
+            if (popped) {
+                return true;
+            }
+
+            // Both looked empty: sweep all shards once before giving up.
+            for (int k = 0; k < _shard_count; ++k) {
+                Shard* shard = &_shards[k];
+                pthread_mutex_lock(&shard->lock);
+                popped = pop_better(shard, 0, out, sequence, stamp);
+                pthread_mutex_unlock(&shard->lock);
+                if (popped) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  public:
+    /**
+     * @brief Creates a queue with factor * threads shards.
+     *
+     * @param threads Expected number of worker threads (P >= 1).
+     * @param factor Shards per thread (c >= 1); 2 is the usual choice.
+     */
+    explicit MultiQueue(int threads, int factor = 2,
+                        Compare const& compare = Compare())
+        : _shards(0), _shard_count(threads * factor), _compare(compare),
+          _size(0) {
+        assert(threads >= 1 && factor >= 1);
+        if (_shard_count < 2) {
+            _shard_count = 2; // Two-choice pops need at least two shards.
+        }
+        _shards = new Shard[_shard_count];
+        for (int i = 0; i < _shard_count; ++i) {
+            pthread_mutex_init(&_shards[i].lock, 0);
+            _shards[i].heap = Heap2<T, 2, Compare>(compare);
+        }
+    }
+
+    // Destructor
+    ~MultiQueue() {
+        for (int i = 0; i < _shard_count; ++i) {
+            pthread_mutex_destroy(&_shards[i].lock);
+        }
+        delete[] _shards;
+    }
+
+    /**
+     * @brief Inserts a value into a random shard. O(log(n / shards)) once a
+     * free shard is found.
+     *
+     * @param value The value to insert.
+     * @param seed The calling thread's random state.
+     */
+    void push(T const& value, unsigned int& seed) {
+        Shard* shard;
+        do {
+            shard = &_shards[next_random(seed) % _shard_count];
+        } while (pthread_mutex_trylock(&shard->lock) != 0);
+        shard->heap.push(value);
+        __sync_fetch_and_add(&_size, 1);
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    /**
+     * @brief Removes a value close to the top of the queue.
+     *
+     * Two random shards are try-locked and the better of their tops is
+     * popped. If both are empty, every shard is checked once (blocking) so
+     * that false is only returned when the queue was seen empty.
+     *
+     * @param out Receives the popped value.
+     * @param seed The calling thread's random state.
+     *
+     * @return true if a value was popped.
+     */
+    bool try_pop(T& out, unsigned int& seed) {
+        return pop_stamped(out, seed, 0, 0);
+    }
+
+    /**
+     * @brief try_pop() that also numbers the pop: stamp receives the next
+     * value of sequence, taken while the popping shard is still locked. The
+     * stamps of one shard's pops are thus in pop order, and replaying all
+     * pops by stamp measures the queue's rank error without noise from
+     * threads racing between the pop and the stamp.
+     *
+     * @param out Receives the popped value.
+     * @param seed The calling thread's random state.
+     * @param sequence Pop counter shared by the popping threads.
+     * @param stamp Receives the pop's number.
+     *
+     * @return true if a value was popped.
+     */
+    bool try_pop(T& out, unsigned int& seed, volatile int& sequence,
+                 int& stamp) {
+        return pop_stamped(out, seed, &sequence, &stamp);
+    }
+
+    /**
+     * @brief Provides the number of values in the queue. Exact when no other
+     * thread is pushing or popping, approximate otherwise.
+     *
+     * @return The number of values in the queue.
+     */
+    int size() const {
+        return _size;
+    }
+
+    // Number of Heap2 shards.
+    int shard_count() const {
+        return _shard_count;
+    }
+};
+
+#endif // MULTI_QUEUE_H
@@ -0,0 +1,415 @@
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+// C++98-only, no STL containers. Header defines templated implementation.
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+/**
+ * PairingNode
+ * A heap-ordered multiway tree node in child/sibling form.
+ * child is the leftmost child, sibling the next child of the same parent.
+ * While a node sits in the pool's free list, sibling links the free list.
+ */
+template <typename T> struct PairingNode {
+    T value;
+    PairingNode* child;
+    PairingNode* sibling;
+
+    PairingNode() : value(), child(0), sibling(0) {}
+};
+
+/**
+ * PairingNodePool
+ * Hands out PairingNodes from blocks of BLOCK_NODES nodes and recycles them
+ * through a free list, so push/pop do not call new/delete per element.
+ *
+ * Both the block chain and the free list keep a tail pointer so that two
+ * pools can be spliced together in O(1); this is what makes meld() O(1).
+ */
+template <typename T> struct PairingNodePool {
+  private:
+    typedef PairingNode<T> PNode;
+
+    static const int BLOCK_NODES = 256;
+
+    struct Block {
+        PNode nodes[BLOCK_NODES];
+        Block* next;
+    };
+
+    Block* blocks_;     // Chain of all allocated blocks.
+    Block* last_block_; // Tail of the block chain.
+    PNode* free_head_;  // Recycled nodes, linked through sibling.
+    PNode* free_tail_;
+
+    // Not copyable: nodes are owned by exactly one pool.
+    PairingNodePool(PairingNodePool const&);
+    PairingNodePool& operator=(PairingNodePool const&);
+
+    /**
+     * @brief Allocates a new block and puts all its nodes on the free list.
+     */
+    void grow() {
+        Block* block = new Block;
+        block->next = 0;
+        if (last_block_ == 0) {
+            blocks_ = block;
+        } else {
+            last_block_->next = block;
+        }
+        last_block_ = block;
+
+        for (int i = 0; i < BLOCK_NODES - 1; ++i) {
+            block->nodes[i].sibling = &block->nodes[i + 1];
+        }
+        block->nodes[BLOCK_NODES - 1].sibling = 0;
+        free_head_ = &block->nodes[0];
+        free_tail_ = &block->nodes[BLOCK_NODES - 1];
+    }
+
+  public:
+    PairingNodePool()
+        : blocks_(0), last_block_(0), free_head_(0), free_tail_(0) {}
+
+    ~PairingNodePool() {
+        clear();
+    }
+
+    /**
+     * @brief Frees every block. All nodes handed out become invalid.
+     */
+    void clear() {
+        while (blocks_ != 0) {
+            Block* next = blocks_->next;
+            delete blocks_;
+            blocks_ = next;
+        }
+        last_block_ = 0;
+        free_head_ = 0;
+        free_tail_ = 0;
+    }
+
+    /**
+     * @brief Takes a node from the free list (growing the pool if needed) and
+     * initializes it as a single-node tree holding value.
+     *
+     * @param value The value to store in the node.
+     *
+     * @return The initialized node.
+     */
+    PNode* acquire(T const& value) {
+        if (free_head_ == 0) {
+            grow();
+        }
+        PNode* node = free_head_;
+        free_head_ = node->sibling;
+        if (free_head_ == 0) {
+            free_tail_ = 0;
+        }
+        node->value = value;
+        node->child = 0;
+        node->sibling = 0;
+        return node;
+    }
+
+    /**
+     * @brief Returns a node to the free list.
+     *
+     * @param node The node to recycle; must not be linked into a heap.
+     */
+    void release(PNode* node) {
+        node->child = 0;
+        node->sibling = free_head_;
+        free_head_ = node;
+        if (free_tail_ == 0) {
+            free_tail_ = node;
+        }
+    }
+
+    /**
+     * @brief Moves every block and free node of other into this pool in O(1).
+     * other is left empty.
+     *
+     * @param other The pool to take over.
+     */
+    void splice(PairingNodePool& other) {
+        if (other.blocks_ != 0) {
+            if (last_block_ == 0) {
+                blocks_ = other.blocks_;
+            } else {
+                last_block_->next = other.blocks_;
+            }
+            last_block_ = other.last_block_;
+        }
+        if (other.free_head_ != 0) {
+            if (free_tail_ == 0) {
+                free_head_ = other.free_head_;
+            } else {
+                free_tail_->sibling = other.free_head_;
+            }
+            free_tail_ = other.free_tail_;
+        }
+        other.blocks_ = 0;
+        other.last_block_ = 0;
+        other.free_head_ = 0;
+        other.free_tail_ = 0;
+    }
+
+    /**
+     * @brief Swaps the contents of this pool with another pool.
+     *
+     * @param other The pool to swap with.
+     */
+    void swap(PairingNodePool& other) {
+        Block* t_blocks = blocks_;
+        blocks_ = other.blocks_;
+        other.blocks_ = t_blocks;
+
+        Block* t_last = last_block_;
+        last_block_ = other.last_block_;
+        other.last_block_ = t_last;
+
+        PNode* t_head = free_head_;
+        free_head_ = other.free_head_;
+        other.free_head_ = t_head;
+
+        PNode* t_tail = free_tail_;
+        free_tail_ = other.free_tail_;
+        other.free_tail_ = t_tail;
+    }
+};
+
+/**
+ * PairingHeap
+ * A meldable min-heap (pairing heap) with the same push/pop/peek/size
+ * surface as Heap2, plus O(1) meld().
+ *
+ * Invariants:
+ *  - _root is NULL iff _size == 0, and _root->sibling is always NULL.
+ *  - Every node's value is >= its parent's value (min-heap order).
+ *  - Every node in the tree was handed out by _pool.
+ */
+template <typename T> struct PairingHeap {
+  private:
+    typedef PairingNode<T> PNode;
+
+    PairingNodePool<T> _pool;
+    PNode* _root;
+    int _size;
+
+    /**
+     * @brief Links two heap-ordered trees: the root with the larger value
+     * becomes the leftmost child of the other.
+     *
+     * @param a Root of the first tree (sibling must be NULL).
+     * @param b Root of the second tree (sibling must be NULL).
+     *
+     * @return Root of the linked tree.
+     */
+    static PNode* link(PNode* a, PNode* b) {
+        if (b->value < a->value) {
+            PNode* temp = a;
+            a = b;
+            b = temp;
+        }
+        b->sibling = a->child;
+        a->child = b;
+        return a;
+    }
+
+    /**
+     * @brief Combines the children of a removed root with the standard
+     * two-pass pairing: link the children in pairs from left to right, then
+     * link the resulting trees from right to left.
+     *
+     * Done iteratively (the first pass builds a reversed list through
+     * sibling), so long child lists cannot overflow the stack.
+     *
+     * @param first Leftmost child of the removed root (may be NULL).
+     *
+     * @return Root of the combined tree, or NULL if there were no children.
+     */
+    static PNode* merge_pairs(PNode* first) {
+        PNode* pairs = 0; // Linked pairs, most recent first.
+        PNode* curr = first;
+        while (curr != 0) {
+            PNode* a = curr;
+            PNode* b = a->sibling;
+            if (b == 0) {
+                a->sibling = pairs;
+                pairs = a;
+                break;
+            }
+            curr = b->sibling;
+            a->sibling = 0;
+            b->sibling = 0;
+            PNode* linked = link(a, b);
+            linked->sibling = pairs;
+            pairs = linked;
+        }
+
+        PNode* result = 0;
+        while (pairs != 0) {
+            PNode* next = pairs->sibling;
+            pairs->sibling = 0;
+            result = (result == 0) ? pairs : link(result, pairs);
+            pairs = next;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Copies the tree of other into this (empty) heap's pool.
+     *
+     * Uses an explicit stack of (source, copy) pairs instead of recursion,
+     * since sibling chains can be as long as the heap.
+     *
+     * @param other The heap to copy from.
+     */
+    void copy_from_other(PairingHeap const& other) {
+        _size = other._size;
+        if (other._root == 0) {
+            _root = 0;
+            return;
+        }
+        _root = _pool.acquire(other._root->value);
+
+        DynamicallySizedArray<PNode const*> sources;
+        DynamicallySizedArray<PNode*> copies;
+        sources.push_back(other._root);
+        copies.push_back(_root);
+        while (!sources.empty()) {
+            PNode const* source = sources.back();
+            PNode* copy = copies.back();
+            sources.pop_back();
+            copies.pop_back();
+
+            // Copy the child list left to right, queueing each child.
+            PNode* prev = 0;
+            for (PNode const* c = source->child; c != 0; c = c->sibling) {
+                PNode* c_copy = _pool.acquire(c->value);
+                if (prev == 0) {
+                    copy->child = c_copy;
+                } else {
+                    prev->sibling = c_copy;
+                }
+                prev = c_copy;
+                if (c->child != 0) {
+                    sources.push_back(c);
+                    copies.push_back(c_copy);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Swaps the contents of this heap with another heap.
+     *
+     * @param other The heap to swap with.
+     */
+    void swap(PairingHeap& other) {
+        _pool.swap(other._pool);
+
+        PNode* t_root = _root;
+        _root = other._root;
+        other._root = t_root;
+
+        int t_size = _size;
+        _size = other._size;
+        other._size = t_size;
+    }
+
+  public:
+    // Constructor
+    PairingHeap() : _pool(), _root(0), _size(0) {}
+
+    // Copy Constructor: deep copy
+    PairingHeap(PairingHeap const& other) : _pool(), _root(0), _size(0) {
+        copy_from_other(other);
+    }
+
+    // Assignment operator: deep copy via copy-and-swap
+    PairingHeap& operator=(PairingHeap const& other) {
+        if (this != &other) {
+            PairingHeap tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Destructor: the pool frees all nodes block by block.
+    ~PairingHeap() {}
+
+    /**
+     * @brief Inserts an element into the heap.
+     *
+     * The value becomes a one-node tree that is linked with the root.
+     * O(1).
+     *
+     * @param value The value to insert into the heap.
+     */
+    void push(T const& value) {
+        PNode* node = _pool.acquire(value);
+        _root = (_root == 0) ? node : link(_root, node);
+        ++_size;
+    }
+
+    /**
+     * @brief Removes the smallest element from the heap.
+     *
+     * The root is removed and its children are combined by two-pass pairing.
+     * Amortized O(log n).
+     *
+     * @return The smallest element that was removed from the heap.
+     */
+    T pop() {
+        assert(_root != 0);
+        PNode* old_root = _root;
+        T minVal = old_root->value;
+        _root = merge_pairs(old_root->child);
+        _pool.release(old_root);
+        --_size;
+        return minVal;
+    }
+
+    /**
+     * @brief Provides access to the smallest element in the heap.
+     *
+     * @return The smallest element in the heap. O(1).
+     */
+    T const& peek() const {
+        assert(_root != 0);
+        return _root->value;
+    }
+
+    /**
+     * @brief Provides the size of the heap.
+     *
+     * @return The number of elements in the heap. O(1).
+     */
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Moves every element of other into this heap.
+     *
+     * The two roots are linked and other's node pool is spliced into ours,
+     * so no element is copied. O(1). other is left empty.
+     *
+     * @param other The heap to meld into this one.
+     */
+    void meld(PairingHeap& other) {
+        if (this == &other || other._root == 0) {
+            return;
+        }
+        _root = (_root == 0) ? other._root : link(_root, other._root);
+        _size += other._size;
+        _pool.splice(other._pool);
+        other._root = 0;
+        other._size = 0;
+    }
+};
+
+#endif // PAIRING_HEAP_H
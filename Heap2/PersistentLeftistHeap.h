@@ -0,0 +1,219 @@
+#ifndef PERSISTENT_LEFTIST_HEAP_H
+#define PERSISTENT_LEFTIST_HEAP_H
+
+// C++98-only, no STL containers. Header defines templated implementation.
+#include "RefCountedArena.h"
+#include <cassert>
+
+/**
+ * LeftistNode
+ * An immutable node of a persistent leftist heap. Once a node is linked
+ * into a heap its value and children never change, so any number of heaps
+ * can share it; refs counts the parents and heap roots pointing at it.
+ */
+template <typename T> struct LeftistNode {
+    T value;
+    LeftistNode* left;
+    LeftistNode* right; // Also links the arena's free list.
+    int rank;           // Length of the right spine (null path length).
+    int refs;
+
+    LeftistNode() : value(), left(0), right(0), rank(0), refs(0) {}
+};
+
+/**
+ * PersistentLeftistHeap
+ * A purely functional (path-copying) leftist min-heap with the Heap2
+ * push/pop/peek/size surface. Operations never modify existing nodes; they
+ * copy the O(log n) nodes on the merged right spines and share the rest, so:
+ *  - copy construction and assignment are O(1) snapshots,
+ *  - push, pop and meld are O(log n) and allocate O(log n) nodes.
+ *
+ * Nodes come from a RefCountedArena shared by a heap and the snapshots taken
+ * from it (a family), created by the first and freed with the last. Melding
+ * in a heap of another family joins the two arenas in O(1), so the merged
+ * heap can share the other heap's nodes. Not thread-safe.
+ */
+template <typename T> struct PersistentLeftistHeap {
+  private:
+    typedef LeftistNode<T> LNode;
+    typedef RefCountedArena<LNode> Arena;
+
+    Arena* _arena; // Shared with the heaps this one was copied from / to,
+                   // or melded with (possibly a stub; see settle_arena()).
+    LNode* _root;
+    int _size;
+
+    /**
+     * @brief Hands out a fresh node with one reference.
+     *
+     * @param value The node's value.
+     * @param left Left child (its reference is taken over by the node).
+     * @param right Right child (its reference is taken over by the node).
+     *
+     * @return The new node; rank is computed and the children are ordered so
+     * that rank(left) >= rank(right).
+     */
+    LNode* make(T const& value, LNode* left, LNode* right) {
+        int left_rank = (left == 0) ? 0 : left->rank;
+        int right_rank = (right == 0) ? 0 : right->rank;
+        if (left_rank < right_rank) {
+            LNode* temp = left;
+            left = right;
+            right = temp;
+            right_rank = left_rank;
+        }
+        LNode* node = _arena->allocate();
+        node->value = value;
+        node->left = left;
+        node->right = right;
+        node->rank = right_rank + 1;
+        return node;
+    }
+
+    // Moves this heap onto the live arena if its family has been joined
+    // into another one since it last allocated or released.
+    void settle_arena() {
+        _arena = _arena->settle();
+    }
+
+    /**
+     * @brief Merges two heaps without modifying either.
+     *
+     * The root with the smaller value is copied; its left subtree is shared
+     * and its right subtree is the merge of its old right subtree with the
+     * other heap. Recursion only follows right spines, which have length
+     * O(log n) in a leftist heap.
+     *
+     * @return A new reference to the merged heap's root.
+     */
+    LNode* merge(LNode* a, LNode* b) {
+        if (a == 0) {
+            Arena::retain(b);
+            return b;
+        }
+        if (b == 0) {
+            Arena::retain(a);
+            return a;
+        }
+        if (b->value < a->value) {
+            LNode* temp = a;
+            a = b;
+            b = temp;
+        }
+        LNode* right = merge(a->right, b);
+        Arena::retain(a->left);
+        return make(a->value, a->left, right);
+    }
+
+  public:
+    // Constructor
+    PersistentLeftistHeap() : _arena(new Arena()), _root(0), _size(0) {}
+
+    // Copy Constructor: O(1) snapshot sharing all nodes (and the arena).
+    PersistentLeftistHeap(PersistentLeftistHeap const& other)
+        : _arena(other._arena->share()), _root(other._root),
+          _size(other._size) {
+        Arena::retain(_root);
+    }
+
+    // Assignment operator: O(1) snapshot sharing all nodes; this heap joins
+    // other's family.
+    PersistentLeftistHeap& operator=(PersistentLeftistHeap const& other) {
+        if (this != &other) {
+            Arena::retain(other._root); // Retain first: roots may be shared.
+            settle_arena();
+            _arena->release(_root);
+            if (_arena != other._arena) {
+                _arena->drop();
+                _arena = other._arena->share();
+            }
+            _root = other._root;
+            _size = other._size;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~PersistentLeftistHeap() {
+        settle_arena();
+        _arena->release(_root);
+        _arena->drop();
+    }
+
+    /**
+     * @brief Inserts an element into the heap by merging with a one-node
+     * heap. O(log n).
+     *
+     * @param value The value to insert into the heap.
+     */
+    void push(T const& value) {
+        settle_arena();
+        LNode* single = make(value, 0, 0);
+        LNode* merged = merge(_root, single);
+        _arena->release(single);
+        _arena->release(_root);
+        _root = merged;
+        ++_size;
+    }
+
+    /**
+     * @brief Removes the smallest element from the heap by merging the
+     * root's two subtrees. O(log n).
+     *
+     * @return The smallest element that was removed from the heap.
+     */
+    T pop() {
+        assert(_root != 0);
+        T minVal = _root->value;
+        settle_arena();
+        LNode* merged = merge(_root->left, _root->right);
+        _arena->release(_root);
+        _root = merged;
+        --_size;
+        return minVal;
+    }
+
+    /**
+     * @brief Provides access to the smallest element in the heap. O(1).
+     *
+     * @return The smallest element in the heap.
+     */
+    T const& peek() const {
+        assert(_root != 0);
+        return _root->value;
+    }
+
+    /**
+     * @brief Provides the size of the heap. O(1).
+     *
+     * @return The number of elements in the heap.
+     */
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Adds every element of other to this heap. O(log n + log m); if
+     * other is of another family, the two arenas are first joined in O(1).
+     * other is not modified.
+     *
+     * @param other The heap to meld into this one.
+     */
+    void meld(PersistentLeftistHeap const& other) {
+        settle_arena();
+        Arena* other_arena = Arena::resolve(other._arena);
+        if (other_arena != _arena) {
+            _arena->join(other_arena);
+            settle_arena();
+        }
+        Arena::retain(other._root); // Held across merge: other may be *this.
+        LNode* merged = merge(_root, other._root);
+        _arena->release(other._root);
+        _arena->release(_root);
+        _root = merged;
+        _size += other._size;
+    }
+};
+
+#endif // PERSISTENT_LEFTIST_HEAP_H
@@ -0,0 +1,229 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+// C++98-only, no STL containers. Header defines templated implementation.
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+/**
+ * RadixHeapEntry
+ * A (key, value) pair as stored in and returned by RadixHeap.
+ */
+template <typename Key, typename Value> struct RadixHeapEntry {
+    Key key;
+    Value value;
+};
+
+/**
+ * RadixKey
+ * Maps a key onto its unsigned counterpart, preserving order: unsigned keys
+ * map to themselves, signed keys get their sign bit flipped (so the most
+ * negative key maps to 0). RadixHeap works on these bits, since shifting a
+ * negative signed difference right never reaches 0. Only the integer types
+ * below are specialized; any other Key fails to compile.
+ */
+template <typename Key> struct RadixKey;
+
+template <> struct RadixKey<int> {
+    typedef unsigned int bits_type;
+    static bits_type bits(int key) {
+        return static_cast<bits_type>(key) ^
+               (bits_type(1) << (sizeof(int) * 8 - 1));
+    }
+};
+
+template <> struct RadixKey<unsigned int> {
+    typedef unsigned int bits_type;
+    static bits_type bits(unsigned int key) {
+        return key;
+    }
+};
+
+template <> struct RadixKey<long> {
+    typedef unsigned long bits_type;
+    static bits_type bits(long key) {
+        return static_cast<bits_type>(key) ^
+               (bits_type(1) << (sizeof(long) * 8 - 1));
+    }
+};
+
+template <> struct RadixKey<unsigned long> {
+    typedef unsigned long bits_type;
+    static bits_type bits(unsigned long key) {
+        return key;
+    }
+};
+
+/**
+ * RadixHeap
+ * A monotone min-priority queue for integer keys (int, unsigned int, long or
+ * unsigned long; see RadixKey): every pushed key must be >= the last key
+ * popped (as in Dijkstra or discrete event simulation). Before the first
+ * pop, any key can be pushed, negative ones included.
+ *
+ * Entries live in BUCKETS DynamicallySizedArrays, indexed by the RadixKey
+ * bits of their keys. Bucket 0 holds the keys equal to _last, and bucket
+ * i > 0 holds the keys whose highest bit that differs from _last is bit
+ * i - 1. When bucket 0 runs dry, the first
+ * non-empty bucket is scanned for its minimum, that becomes the new _last and
+ * the bucket is redistributed into strictly lower buckets. Each entry can
+ * only move down, so the amortized cost is O(log C) per entry (C = key
+ * range), with no comparison-based sifting.
+ *
+ * Invariants:
+ *  - Every entry in bucket i satisfies bucket_index(key) == i.
+ *  - Every key in the heap has RadixKey bits >= _last.
+ */
+template <typename Key, typename Value> struct RadixHeap {
+  public:
+    typedef RadixHeapEntry<Key, Value> Entry;
+
+  private:
+    typedef typename RadixKey<Key>::bits_type Bits;
+    static const int KEY_BITS = sizeof(Bits) * 8;
+    static const int BUCKETS = KEY_BITS + 1;
+
+    // Import DSA for DRY.
+    DynamicallySizedArray<Entry> _buckets[BUCKETS];
+    Bits _last; // RadixKey bits of the last popped key; never decreases.
+    int _size;
+
+    /**
+     * @brief Computes the bucket of a key: the bit length of
+     * bits(key) ^ _last.
+     *
+     * @param key The key; must be >= the last popped key.
+     *
+     * @return Bucket index in [0, KEY_BITS].
+     */
+    int bucket_index(Key key) const {
+        Bits diff = RadixKey<Key>::bits(key) ^ _last;
+        int bits = 0;
+        while (diff != 0) {
+            diff >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+
+    /**
+     * @brief Refills bucket 0 from the first non-empty bucket: its smallest
+     * key becomes _last and all of its entries move to lower buckets.
+     */
+    void refill() {
+        int i = 1;
+        while (_buckets[i].empty()) {
+            ++i;
+        }
+        DynamicallySizedArray<Entry>& source = _buckets[i];
+
+        Key new_last = source[0].key;
+        for (int j = 1; j < source.size(); ++j) {
+            if (source[j].key < new_last) {
+                new_last = source[j].key;
+            }
+        }
+        _last = RadixKey<Key>::bits(new_last);
+
+        for (int j = 0; j < source.size(); ++j) {
+            _buckets[bucket_index(source[j].key)].push_back(source[j]);
+        }
+        source.clear();
+    }
+
+  public:
+    // Constructor
+    RadixHeap() : _last(0), _size(0) {}
+
+    // Copy Constructor
+    RadixHeap(RadixHeap const& other) : _last(other._last), _size(other._size) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            _buckets[i] = other._buckets[i];
+        }
+    }
+
+    // Assignment operator
+    RadixHeap& operator=(RadixHeap const& other) {
+        if (this != &other) {
+            for (int i = 0; i < BUCKETS; ++i) {
+                _buckets[i] = other._buckets[i];
+            }
+            _last = other._last;
+            _size = other._size;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~RadixHeap() {}
+
+    /**
+     * @brief Inserts an entry. O(1) plus the bit-length computation.
+     *
+     * @param key The priority; must be >= the last popped key.
+     * @param value The payload.
+     */
+    void push(Key const& key, Value const& value) {
+        assert(!(RadixKey<Key>::bits(key) < _last));
+        Entry entry;
+        entry.key = key;
+        entry.value = value;
+        _buckets[bucket_index(key)].push_back(entry);
+        ++_size;
+    }
+
+    /**
+     * @brief Removes the entry with the smallest key. Amortized O(log C).
+     *
+     * @return The removed entry.
+     */
+    Entry pop() {
+        assert(_size > 0);
+        if (_buckets[0].empty()) {
+            refill();
+        }
+        Entry top = _buckets[0].back();
+        _buckets[0].pop_back();
+        --_size;
+        return top;
+    }
+
+    /**
+     * @brief Provides access to the entry with the smallest key.
+     *
+     * O(1) while bucket 0 is non-empty; otherwise the first non-empty bucket
+     * is scanned (without redistributing it, since that would raise _last
+     * above keys that may still legally be pushed).
+     *
+     * @return The entry with the smallest key.
+     */
+    Entry const& peek() const {
+        assert(_size > 0);
+        if (!_buckets[0].empty()) {
+            return _buckets[0].back();
+        }
+        int i = 1;
+        while (_buckets[i].empty()) {
+            ++i;
+        }
+        DynamicallySizedArray<Entry> const& source = _buckets[i];
+        int best = 0;
+        for (int j = 1; j < source.size(); ++j) {
+            if (source[j].key < source[best].key) {
+                best = j;
+            }
+        }
+        return source[best];
+    }
+
+    /**
+     * @brief Provides the size of the heap. O(1).
+     *
+     * @return The number of entries in the heap.
+     */
+    int size() const {
+        return _size;
+    }
+};
+
+#endif // RADIX_HEAP_H
@@ -0,0 +1,222 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+#include "Heap2.h"
+#include <cassert>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * TopKPrefilter
+ * Finds the first value in a run that can still enter a full TopK, i.e. the
+ * first value v with compare(threshold, v). The generic version is a plain
+ * scan; the int specializations below compare four values per SSE2
+ * instruction so that long runs of rejected values are skipped cheaply.
+ */
+template <typename T, typename Compare> struct TopKPrefilter {
+    static int first_candidate(T const* data, int n, T const& threshold,
+                               Compare const& compare) {
+        for (int i = 0; i < n; ++i) {
+            if (compare(threshold, data[i])) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+#ifdef __SSE2__
+// Index of the first set bit in a 4-bit movemask (mask must be non-zero).
+inline int topk_first_lane(int mask) {
+    int lane = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++lane;
+    }
+    return lane;
+}
+
+// k largest ints: a value is a candidate when it is > threshold.
+template <> struct TopKPrefilter<int, HeapLess<int> > {
+    static int first_candidate(int const* data, int n, int const& threshold,
+                               HeapLess<int> const&) {
+        __m128i thr = _mm_set1_epi32(threshold);
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v =
+                _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+            int mask =
+                _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, thr)));
+            if (mask != 0) {
+                return i + topk_first_lane(mask);
+            }
+        }
+        for (; i < n; ++i) {
+            if (threshold < data[i]) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+// k smallest ints: a value is a candidate when it is < threshold.
+template <> struct TopKPrefilter<int, HeapGreater<int> > {
+    static int first_candidate(int const* data, int n, int const& threshold,
+                               HeapGreater<int> const&) {
+        __m128i thr = _mm_set1_epi32(threshold);
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v =
+                _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+            int mask =
+                _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, thr)));
+            if (mask != 0) {
+                return i + topk_first_lane(mask);
+            }
+        }
+        for (; i < n; ++i) {
+            if (data[i] < threshold) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+#endif // __SSE2__
+
+/**
+ * TopK
+ * Keeps the k "best" values of a stream in O(k) memory: with the default
+ * HeapLess<T> the k largest, with HeapGreater<T> the k smallest.
+ *
+ * Backed by a Heap2 whose top is the worst value kept (the admission
+ * threshold). Once full, a new value only enters if it beats the threshold,
+ * and then replaces it with a single sift (Heap2::replace_top).
+ */
+template <typename T, typename Compare = HeapLess<T> > struct TopK {
+  private:
+    Heap2<T, 2, Compare> _heap;
+    Compare _compare;
+    int _capacity;
+
+  public:
+    /**
+     * @brief Creates an empty selector for the k best values.
+     *
+     * @param k Number of values to keep (>= 1).
+     * @param compare Ordering; the k values that compare greatest are kept.
+     */
+    explicit TopK(int k, Compare const& compare = Compare())
+        : _heap(compare), _compare(compare), _capacity(k) {
+        assert(k >= 1);
+    }
+
+    // Copy Constructor
+    TopK(TopK const& other)
+        : _heap(other._heap), _compare(other._compare),
+          _capacity(other._capacity) {}
+
+    // Assignment operator
+    TopK& operator=(TopK const& other) {
+        if (this != &other) {
+            _heap = other._heap;
+            _compare = other._compare;
+            _capacity = other._capacity;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~TopK() {}
+
+    /**
+     * @brief Offers one value. O(1) if it is rejected, O(log k) otherwise.
+     *
+     * @param value The value to consider.
+     *
+     * @return true if the value was kept.
+     */
+    bool push(T const& value) {
+        if (_heap.size() < _capacity) {
+            _heap.push(value);
+            return true;
+        }
+        if (!_compare(_heap.peek(), value)) {
+            return false;
+        }
+        _heap.replace_top(value);
+        return true;
+    }
+
+    /**
+     * @brief Offers n values at once.
+     *
+     * Once the selector is full, runs of values that cannot beat the current
+     * threshold are skipped by TopKPrefilter (SSE2 for int) without touching
+     * the heap. O(n) scan plus O(log k) per accepted value.
+     *
+     * @param first Pointer to the first value.
+     * @param n Number of values.
+     */
+    void push_batch(T const* first, int n) {
+        int i = 0;
+        while (i < n && _heap.size() < _capacity) {
+            _heap.push(first[i++]);
+        }
+        while (i < n) {
+            i += TopKPrefilter<T, Compare>::first_candidate(
+                first + i, n - i, _heap.peek(), _compare);
+            if (i == n) {
+                break;
+            }
+            _heap.replace_top(first[i++]);
+        }
+    }
+
+    /**
+     * @brief Offers every value kept by other, e.g. to combine per-thread
+     * partial results. O(k log k). other is unchanged.
+     *
+     * @param other Another selector (its capacity may differ).
+     */
+    void merge(TopK const& other) {
+        Heap2<T, 2, Compare> rest(other._heap);
+        while (rest.size() > 0) {
+            push(rest.pop());
+        }
+    }
+
+    /**
+     * @brief Provides the admission threshold: the worst value kept. O(1).
+     *
+     * @return The worst value currently kept.
+     */
+    T const& peek() const {
+        return _heap.peek();
+    }
+
+    /**
+     * @brief Removes the worst value kept. O(log k).
+     *
+     * Popping until empty yields the kept values from worst to best.
+     *
+     * @return The removed value.
+     */
+    T pop() {
+        return _heap.pop();
+    }
+
+    // Number of values kept (<= capacity()).
+    int size() const {
+        return _heap.size();
+    }
+
+    // The k passed at construction.
+    int capacity() const {
+        return _capacity;
+    }
+};
+
+#endif // TOP_K_H
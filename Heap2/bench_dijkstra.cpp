@@ -0,0 +1,154 @@
+// bench_dijkstra.cpp
+// Benchmark: Dijkstra on large synthetic graphs with Heap2 vs. RadixHeap.
+//
+// The graph is a random directed graph in CSR form: every node gets DEGREE
+// out-edges to random nodes with weights in [1, MAX_WEIGHT], plus an edge to
+// the next node so everything is reachable. Both variants use the usual
+// "push duplicates, skip stale pops" scheme so that only the queue differs.
+//
+// Usage: ./bin/bench_dijkstra [N ...]   (default: 1000000 4000000)
+
+#include "BenchUtil.h"
+#include "Heap2.h"
+#include "RadixHeap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int DEGREE = 4;
+static const unsigned int MAX_WEIGHT = 1000;
+static const unsigned int INF = 0xffffffffu;
+
+struct Graph {
+    int n;
+    int* first_edge; // n + 1 offsets into target/weight.
+    int* target;
+    unsigned int* weight;
+};
+
+struct HeapItem {
+    unsigned int dist;
+    int node;
+    bool operator<(HeapItem const& other) const {
+        return dist < other.dist;
+    }
+};
+
+static Graph make_graph(int n) {
+    Graph g;
+    g.n = n;
+    int m = n * (DEGREE + 1);
+    g.first_edge = new int[n + 1];
+    g.target = new int[m];
+    g.weight = new unsigned int[m];
+
+    XorShift32 rng(88172645u);
+    int e = 0;
+    for (int u = 0; u < n; ++u) {
+        g.first_edge[u] = e;
+        g.target[e] = (u + 1) % n;
+        g.weight[e] = 1 + rng.next() % MAX_WEIGHT;
+        ++e;
+        for (int k = 0; k < DEGREE; ++k) {
+            g.target[e] = static_cast<int>(rng.next() % n);
+            g.weight[e] = 1 + rng.next() % MAX_WEIGHT;
+            ++e;
+        }
+    }
+    g.first_edge[n] = e;
+    return g;
+}
+
+static void free_graph(Graph& g) {
+    delete[] g.first_edge;
+    delete[] g.target;
+    delete[] g.weight;
+}
+
+static unsigned long checksum(unsigned int const* dist, int n) {
+    unsigned long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += dist[i];
+    }
+    return sum;
+}
+
+static void dijkstra_heap2(Graph const& g, unsigned int* dist) {
+    for (int i = 0; i < g.n; ++i) {
+        dist[i] = INF;
+    }
+    Heap2<HeapItem> heap;
+    HeapItem start;
+    start.dist = 0;
+    start.node = 0;
+    dist[0] = 0;
+    heap.push(start);
+    while (heap.size() > 0) {
+        HeapItem item = heap.pop();
+        if (item.dist != dist[item.node]) {
+            continue; // Stale entry.
+        }
+        for (int e = g.first_edge[item.node]; e < g.first_edge[item.node + 1];
+             ++e) {
+            unsigned int nd = item.dist + g.weight[e];
+            if (nd < dist[g.target[e]]) {
+                dist[g.target[e]] = nd;
+                HeapItem next;
+                next.dist = nd;
+                next.node = g.target[e];
+                heap.push(next);
+            }
+        }
+    }
+}
+
+static void dijkstra_radix(Graph const& g, unsigned int* dist) {
+    for (int i = 0; i < g.n; ++i) {
+        dist[i] = INF;
+    }
+    RadixHeap<unsigned int, int> heap;
+    dist[0] = 0;
+    heap.push(0, 0);
+    while (heap.size() > 0) {
+        RadixHeapEntry<unsigned int, int> item = heap.pop();
+        if (item.key != dist[item.value]) {
+            continue; // Stale entry.
+        }
+        for (int e = g.first_edge[item.value];
+             e < g.first_edge[item.value + 1]; ++e) {
+            unsigned int nd = item.key + g.weight[e];
+            if (nd < dist[g.target[e]]) {
+                dist[g.target[e]] = nd;
+                heap.push(nd, g.target[e]);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int default_sizes[] = {1000000, 4000000};
+    int count = argc > 1 ? argc - 1 : 2;
+    for (int i = 0; i < count; ++i) {
+        int n = argc > 1 ? std::atoi(argv[i + 1]) : default_sizes[i];
+        Graph g = make_graph(n);
+        unsigned int* dist = new unsigned int[n];
+
+        clock_t start = clock();
+        dijkstra_heap2(g, dist);
+        double t_heap = seconds_since(start);
+        unsigned long sum_heap = checksum(dist, n);
+
+        start = clock();
+        dijkstra_radix(g, dist);
+        double t_radix = seconds_since(start);
+        unsigned long sum_radix = checksum(dist, n);
+
+        std::printf("n=%-9d m=%-9d heap2 %.3fs  radix %.3fs  speedup %.2fx  "
+                    "(%s)\n",
+                    n, g.first_edge[n], t_heap, t_radix, t_heap / t_radix,
+                    sum_heap == sum_radix ? "distances match" : "MISMATCH");
+        delete[] dist;
+        free_graph(g);
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// bench_heap2.cpp
+// Benchmark: Heap2 push/pop throughput across arities and heap sizes, with
+// PairingHeap as a node-based reference.
+//
+// For every size N the same N random ints are pushed into an empty heap and
+// then popped until it is empty. Throughput is reported in millions of
+// operations per second for each phase.
+//
+// Usage: ./bin/bench_heap2 [N ...]   (default: 100000 1000000 10000000)
+
+#include "BenchUtil.h"
+#include "Heap2.h"
+#include "PairingHeap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+template <typename Heap>
+static void bench_heap(char const* name, int const* keys, int n) {
+    Heap heap;
+
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        heap.push(keys[i]);
+    }
+    double t_push = seconds_since(start);
+
+    start = clock();
+    unsigned long checksum = 0;
+    int prev = heap.size() > 0 ? heap.peek() : 0;
+    bool sorted = true;
+    while (heap.size() > 0) {
+        int value = heap.pop();
+        sorted = sorted && !(value < prev);
+        prev = value;
+        checksum += static_cast<unsigned int>(value);
+    }
+    double t_pop = seconds_since(start);
+
+    std::printf("%-8s n=%-9d push %7.2f Mops/s  pop %7.2f Mops/s  "
+                "(%s, checksum %lu)\n",
+                name, n, n / t_push / 1e6, n / t_pop / 1e6,
+                sorted ? "sorted" : "NOT SORTED", checksum);
+}
+
+int main(int argc, char** argv) {
+    int default_sizes[] = {100000, 1000000, 10000000};
+    int count = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < count; ++i) {
+        int n = argc > 1 ? std::atoi(argv[i + 1]) : default_sizes[i];
+        int* keys = new int[n];
+        XorShift32 rng(2463534242u);
+        for (int j = 0; j < n; ++j) {
+            keys[j] = static_cast<int>(rng.next());
+        }
+        bench_heap<Heap2<int, 2> >("arity 2", keys, n);
+        bench_heap<Heap2<int, 4> >("arity 4", keys, n);
+        bench_heap<Heap2<int, 8> >("arity 8", keys, n);
+        bench_heap<PairingHeap<int> >("pairing", keys, n);
+        delete[] keys;
+    }
+    return 0;
+}
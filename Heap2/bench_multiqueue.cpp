@@ -0,0 +1,211 @@
+// bench_multiqueue.cpp
+// Benchmark: MultiQueue vs. one mutex-protected Heap2, for 1..P threads.
+//
+// Throughput: the queue is prefilled with PREFILL random ints, then every
+// thread runs OPS_PER_THREAD operations, alternating push and pop. Reported
+// as millions of operations per second (wall clock).
+//
+// Rank error: the queue is filled with the keys 0..N-1 and the threads pop
+// it empty concurrently, stamping each pop with a global sequence number
+// while the popping lock is still held. Replaying the pops in sequence
+// order, the rank error of a pop is the number of smaller keys that were
+// still in the queue. The single-lock heap pops and stamps under one lock,
+// so its rank error is 0.
+//
+// Usage: ./bin/bench_multiqueue [max_threads]   (default: 8)
+
+#include "BenchUtil.h"
+#include "Heap2.h"
+#include "MultiQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+
+static const int PREFILL = 1000000;
+static const int OPS_PER_THREAD = 1000000;
+static const int RANK_KEYS = 1000000;
+
+static unsigned int next_random(unsigned int& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// One Heap2 behind one mutex: the baseline the MultiQueue replaces.
+struct LockedHeap {
+    pthread_mutex_t lock;
+    Heap2<int> heap;
+
+    LockedHeap() {
+        pthread_mutex_init(&lock, 0);
+    }
+    ~LockedHeap() {
+        pthread_mutex_destroy(&lock);
+    }
+    void push(int value, unsigned int&) {
+        pthread_mutex_lock(&lock);
+        heap.push(value);
+        pthread_mutex_unlock(&lock);
+    }
+    bool try_pop(int& out, unsigned int&) {
+        pthread_mutex_lock(&lock);
+        bool popped = heap.size() > 0;
+        if (popped) {
+            out = heap.pop();
+        }
+        pthread_mutex_unlock(&lock);
+        return popped;
+    }
+    bool try_pop(int& out, unsigned int&, volatile int& sequence,
+                 int& stamp) {
+        pthread_mutex_lock(&lock);
+        bool popped = heap.size() > 0;
+        if (popped) {
+            out = heap.pop();
+            stamp = __sync_fetch_and_add(&sequence, 1);
+        }
+        pthread_mutex_unlock(&lock);
+        return popped;
+    }
+};
+
+template <typename Queue> struct WorkerArgs {
+    Queue* queue;
+    unsigned int seed;
+    int* popped;           // Rank phase: popped keys, indexed by sequence.
+    volatile int* sequence; // Rank phase: global pop counter.
+};
+
+template <typename Queue> static void* throughput_worker(void* raw) {
+    WorkerArgs<Queue>* args = static_cast<WorkerArgs<Queue>*>(raw);
+    int value;
+    for (int i = 0; i < OPS_PER_THREAD; i += 2) {
+        args->queue->push(static_cast<int>(next_random(args->seed) >> 1),
+                          args->seed);
+        args->queue->try_pop(value, args->seed);
+    }
+    return 0;
+}
+
+template <typename Queue> static void* drain_worker(void* raw) {
+    WorkerArgs<Queue>* args = static_cast<WorkerArgs<Queue>*>(raw);
+    int value;
+    int slot;
+    while (args->queue->try_pop(value, args->seed, *args->sequence, slot)) {
+        args->popped[slot] = value;
+    }
+    return 0;
+}
+
+template <typename Queue>
+static double run_threads(void* (*worker)(void*), Queue* queue, int threads,
+                          int* popped, volatile int* sequence) {
+    pthread_t* ids = new pthread_t[threads];
+    WorkerArgs<Queue>* args = new WorkerArgs<Queue>[threads];
+    double start = wall_seconds();
+    for (int t = 0; t < threads; ++t) {
+        args[t].queue = queue;
+        args[t].seed = 2463534242u + 977u * t;
+        args[t].popped = popped;
+        args[t].sequence = sequence;
+        pthread_create(&ids[t], 0, worker, &args[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(ids[t], 0);
+    }
+    double elapsed = wall_seconds() - start;
+    delete[] ids;
+    delete[] args;
+    return elapsed;
+}
+
+// Mean and max rank error of a pop sequence over the keys 0..n-1, using a
+// Fenwick tree of the keys still present.
+static void rank_error(int const* popped, int n, double& mean, int& max) {
+    int* tree = new int[n + 1];
+    for (int i = 1; i <= n; ++i) {
+        tree[i] = 0;
+    }
+    for (int key = 0; key < n; ++key) {
+        for (int i = key + 1; i <= n; i += i & -i) {
+            ++tree[i];
+        }
+    }
+    double total = 0;
+    max = 0;
+    for (int s = 0; s < n; ++s) {
+        int smaller = 0;
+        for (int i = popped[s]; i > 0; i -= i & -i) {
+            smaller += tree[i];
+        }
+        total += smaller;
+        if (smaller > max) {
+            max = smaller;
+        }
+        for (int i = popped[s] + 1; i <= n; i += i & -i) {
+            --tree[i];
+        }
+    }
+    mean = total / n;
+    delete[] tree;
+}
+
+template <typename Queue>
+static void bench(char const* name, Queue* (*make)(int), int threads) {
+    unsigned int seed = 88172645u;
+
+    Queue* queue = make(threads);
+    for (int i = 0; i < PREFILL; ++i) {
+        queue->push(static_cast<int>(next_random(seed) >> 1), seed);
+    }
+    double elapsed =
+        run_threads(throughput_worker<Queue>, queue, threads, 0, 0);
+    delete queue;
+
+    // Keys 0..n-1 in shuffled order.
+    int* keys = new int[RANK_KEYS];
+    for (int i = 0; i < RANK_KEYS; ++i) {
+        keys[i] = i;
+    }
+    for (int i = RANK_KEYS - 1; i > 0; --i) {
+        int j = next_random(seed) % (i + 1);
+        int temp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = temp;
+    }
+    queue = make(threads);
+    for (int i = 0; i < RANK_KEYS; ++i) {
+        queue->push(keys[i], seed);
+    }
+    volatile int sequence = 0;
+    run_threads(drain_worker<Queue>, queue, threads, keys, &sequence);
+    delete queue;
+
+    double mean;
+    int max;
+    rank_error(keys, RANK_KEYS, mean, max);
+    delete[] keys;
+
+    std::printf("%-11s threads=%-2d %7.2f Mops/s  rank error mean %8.2f  "
+                "max %d\n",
+                name, threads, threads * OPS_PER_THREAD / elapsed / 1e6, mean,
+                max);
+}
+
+static LockedHeap* make_locked(int) {
+    return new LockedHeap();
+}
+
+static MultiQueue<int>* make_multiqueue(int threads) {
+    return new MultiQueue<int>(threads, 2);
+}
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 8;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        bench<LockedHeap>("locked heap", make_locked, threads);
+        bench<MultiQueue<int> >("multiqueue", make_multiqueue, threads);
+    }
+    return 0;
+}
@@ -1,17 +1,30 @@
 // kattis_heap2_template.cpp
 // Kattis main template for: heap2
 
-#include "Heap2.h"
 #include <cassert>
 #include <iostream>
 
+// Build with -DHEAP2_USE_PAIRING (make pairing) or -DHEAP2_USE_PERSISTENT
+// (make persistent) to run the same operations on PairingHeap or
+// PersistentLeftistHeap instead of Heap2.
+#if defined(HEAP2_USE_PAIRING)
+#include "PairingHeap.h"
+typedef PairingHeap<int> heap_type;
+#elif defined(HEAP2_USE_PERSISTENT)
+#include "PersistentLeftistHeap.h"
+typedef PersistentLeftistHeap<int> heap_type;
+#else
+#include "Heap2.h"
+typedef Heap2<int> heap_type;
+#endif
+
 using std::cin;
 using std::cout;
 using std::ws;
 
 static const int MAX_INSTANCES = 1000;
 
-Heap2<int> heaps[MAX_INSTANCES];
+heap_type heaps[MAX_INSTANCES];
 
 int main() {
     int q;
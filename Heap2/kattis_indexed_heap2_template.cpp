@@ -0,0 +1,83 @@
+// kattis_indexed_heap2_template.cpp
+// Kattis main template for: heap2, on IndexedHeap2 (with handle operations)
+
+#include "IndexedHeap2.h"
+#include <cassert>
+#include <iostream>
+
+using std::cin;
+using std::cout;
+using std::ws;
+
+static const int MAX_INSTANCES = 1000;
+
+IndexedHeap2<int> heaps[MAX_INSTANCES];
+
+// Same operations as kattis_heap2_template.cpp, plus (h is a handle; handles
+// are numbered from 0 per heap and freed ones are reused, newest first):
+//   + v    also prints the new element's handle
+//   h      prints the handle of the smallest element
+//   c h    prints 1 if h is live, else 0
+//   v h    prints the value of h
+//   d h v  decrease_key(h, v)
+//   i h v  increase_key(h, v)
+//   e h    erase(h)
+int main() {
+    int q;
+    cin >> q;
+
+    for (int i = 0; i < q; i++) {
+        int instance;
+        cin >> instance;
+        instance--;
+
+        cin >> ws;
+        char op;
+        cin >> op;
+
+        if (op == 'a') {
+            int other;
+            cin >> other;
+            other--;
+            heaps[instance] = heaps[other];
+        } else if (op == '+') {
+            int value;
+            cin >> value;
+            cout << heaps[instance].push(value) << '\n';
+        } else if (op == '-') {
+            heaps[instance].pop();
+        } else if (op == 'p') {
+            cout << heaps[instance].peek() << '\n';
+        } else if (op == 's') {
+            cout << heaps[instance].size() << '\n';
+        } else if (op == 'h') {
+            cout << heaps[instance].peek_handle() << '\n';
+        } else if (op == 'c') {
+            int handle;
+            cin >> handle;
+            cout << (heaps[instance].contains(handle) ? 1 : 0) << '\n';
+        } else if (op == 'v') {
+            int handle;
+            cin >> handle;
+            cout << heaps[instance].value(handle) << '\n';
+        } else if (op == 'd') {
+            int handle;
+            int value;
+            cin >> handle >> value;
+            heaps[instance].decrease_key(handle, value);
+        } else if (op == 'i') {
+            int handle;
+            int value;
+            cin >> handle >> value;
+            heaps[instance].increase_key(handle, value);
+        } else if (op == 'e') {
+            int handle;
+            cin >> handle;
+            heaps[instance].erase(handle);
+        } else {
+            assert(false);
+        }
+    }
+
+    return 0;
+}
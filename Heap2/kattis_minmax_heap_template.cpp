@@ -0,0 +1,57 @@
+// kattis_minmax_heap_template.cpp
+// Kattis main template for: heap2, on MinMaxHeap (both ends)
+
+#include "MinMaxHeap.h"
+#include <cassert>
+#include <iostream>
+
+using std::cin;
+using std::cout;
+using std::ws;
+
+static const int MAX_INSTANCES = 1000;
+
+MinMaxHeap<int> heaps[MAX_INSTANCES];
+
+// Operations: a j (copy heap j), + v (push), s (size), and per end
+//   p / P  peek_min / peek_max (printed)
+//   - / x  pop_min / pop_max (the removed value is printed)
+int main() {
+    int q;
+    cin >> q;
+
+    for (int i = 0; i < q; i++) {
+        int instance;
+        cin >> instance;
+        instance--;
+
+        cin >> ws;
+        char op;
+        cin >> op;
+
+        if (op == 'a') {
+            int other;
+            cin >> other;
+            other--;
+            heaps[instance] = heaps[other];
+        } else if (op == '+') {
+            int value;
+            cin >> value;
+            heaps[instance].push(value);
+        } else if (op == '-') {
+            cout << heaps[instance].pop_min() << '\n';
+        } else if (op == 'x') {
+            cout << heaps[instance].pop_max() << '\n';
+        } else if (op == 'p') {
+            cout << heaps[instance].peek_min() << '\n';
+        } else if (op == 'P') {
+            cout << heaps[instance].peek_max() << '\n';
+        } else if (op == 's') {
+            cout << heaps[instance].size() << '\n';
+        } else {
+            assert(false);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+// kattis_topk_template.cpp
+// Kattis main template for: heap2, on TopK (the k largest values)
+
+#include "TopK.h"
+#include <cassert>
+#include <iostream>
+
+using std::cin;
+using std::cout;
+using std::ws;
+
+static const int MAX_INSTANCES = 1000;
+static const int MAX_BATCH = 100000;
+
+TopK<int>* selectors[MAX_INSTANCES];
+int batch[MAX_BATCH];
+
+// Input: k q, then q operations on selectors that keep the k largest values:
+//   + v          push(v), prints 1 if v was kept, else 0
+//   b n v1..vn   push_batch of the n values
+//   m j          merge(selector j)
+//   p            peek (the worst value kept)
+//   -            pop (the removed value is printed)
+//   s            size
+int main() {
+    int k;
+    int q;
+    cin >> k >> q;
+    for (int i = 0; i < MAX_INSTANCES; i++) {
+        selectors[i] = new TopK<int>(k);
+    }
+
+    for (int i = 0; i < q; i++) {
+        int instance;
+        cin >> instance;
+        instance--;
+
+        cin >> ws;
+        char op;
+        cin >> op;
+
+        if (op == '+') {
+            int value;
+            cin >> value;
+            cout << (selectors[instance]->push(value) ? 1 : 0) << '\n';
+        } else if (op == 'b') {
+            int n;
+            cin >> n;
+            assert(n <= MAX_BATCH);
+            for (int j = 0; j < n; j++) {
+                cin >> batch[j];
+            }
+            selectors[instance]->push_batch(batch, n);
+        } else if (op == 'm') {
+            int other;
+            cin >> other;
+            other--;
+            selectors[instance]->merge(*selectors[other]);
+        } else if (op == 'p') {
+            cout << selectors[instance]->peek() << '\n';
+        } else if (op == '-') {
+            cout << selectors[instance]->pop() << '\n';
+        } else if (op == 's') {
+            cout << selectors[instance]->size() << '\n';
+        } else {
+            assert(false);
+        }
+    }
+
+    for (int i = 0; i < MAX_INSTANCES; i++) {
+        delete selectors[i];
+    }
+    return 0;
+}
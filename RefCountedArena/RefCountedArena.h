@@ -0,0 +1,222 @@
+#ifndef REF_COUNTED_ARENA_H
+#define REF_COUNTED_ARENA_H
+
+// Node arena shared by the persistent (path-copying) structures.
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+/**
+ * RefCountedArena
+ * Block allocator with a free list for reference-counted immutable nodes.
+ * Node needs a default constructor and the fields left, right (which also
+ * links the free list) and int refs.
+ *
+ * One arena serves a family of structures: one built from scratch and
+ * every copy made from it, since copies share nodes. It counts its users: a
+ * copy calls share(), and each member calls drop() when it lets go, the
+ * last one deleting the arena with its blocks.
+ *
+ * Two families can be joined into one in O(1) (join()) when a structure
+ * starts sharing nodes with another family, e.g. on a heap meld. The smaller
+ * arena hands its blocks and free list to the larger and is left behind as
+ * a forwarding stub; its users move to the live arena with settle() before
+ * they next allocate or release. Not thread-safe.
+ */
+template <typename Node> class RefCountedArena {
+  private:
+    static const int BLOCK_NODES = 256;
+
+    struct Block {
+        Node nodes[BLOCK_NODES];
+        Block* next;
+    };
+
+    Block* blocks_; // Singly linked, so join() can splice them in O(1).
+    Block* last_block_;
+    int block_count_;
+    Node* free_list_;
+    Node* free_tail_; // Last node on the free list, for join().
+    DynamicallySizedArray<Node*> dead_; // Scratch stack for release().
+    RefCountedArena* forward_;          // The arena this one joined, if any.
+    int users_; // Structures using this arena, plus stubs forwarding here.
+
+    // Not copyable: owns the blocks.
+    RefCountedArena(RefCountedArena const&);
+    RefCountedArena& operator=(RefCountedArena const&);
+
+    // Destructor: only through drop().
+    ~RefCountedArena() {
+        while (blocks_ != 0) {
+            Block* next = blocks_->next;
+            delete blocks_;
+            blocks_ = next;
+        }
+    }
+
+    // Puts node at the front of the free list.
+    void push_free(Node* node) {
+        node->right = free_list_;
+        if (free_list_ == 0) {
+            free_tail_ = node;
+        }
+        free_list_ = node;
+    }
+
+  public:
+    // Constructor: an empty arena with one user, the caller.
+    RefCountedArena()
+        : blocks_(0), last_block_(0), block_count_(0), free_list_(0),
+          free_tail_(0), dead_(), forward_(0), users_(1) {}
+
+    // Adds a user (a new copy in the family) and returns this arena.
+    RefCountedArena* share() {
+        ++users_;
+        return this;
+    }
+
+    // Removes a user; the last one deletes the arena (and lets go of the
+    // arena it forwards to, if any).
+    void drop() {
+        RefCountedArena* arena = this;
+        while (arena != 0 && --arena->users_ == 0) {
+            RefCountedArena* next = arena->forward_;
+            delete arena;
+            arena = next;
+        }
+    }
+
+    // The live arena that arena's nodes now belong to. O(log k) for k joins.
+    static RefCountedArena* resolve(RefCountedArena* arena) {
+        while (arena->forward_ != 0) {
+            arena = arena->forward_;
+        }
+        return arena;
+    }
+
+    /**
+     * @brief Moves the caller's use of this arena over to the live arena it
+     * was joined into. Call it before allocating or releasing through an
+     * arena that may have been joined since.
+     *
+     * @return The live arena (this one if it was never joined).
+     */
+    RefCountedArena* settle() {
+        RefCountedArena* live = resolve(this);
+        if (live != this) {
+            live->share();
+            drop();
+        }
+        return live;
+    }
+
+    /**
+     * @brief Joins the families of two live arenas, so that nodes of one
+     * may point at nodes of the other. The arena with fewer blocks hands its
+     * blocks and free list to the other and forwards to it. O(1).
+     *
+     * @param other A live arena (see resolve()).
+     *
+     * @return The arena both families now allocate from.
+     */
+    RefCountedArena* join(RefCountedArena* other) {
+        assert(forward_ == 0 && other->forward_ == 0);
+        if (other == this) {
+            return this;
+        }
+        RefCountedArena* big = this;
+        RefCountedArena* small = other;
+        if (big->block_count_ < small->block_count_) {
+            big = other;
+            small = this;
+        }
+        if (small->blocks_ != 0) {
+            small->last_block_->next = big->blocks_;
+            if (big->blocks_ == 0) {
+                big->last_block_ = small->last_block_;
+            }
+            big->blocks_ = small->blocks_;
+            big->block_count_ += small->block_count_;
+        }
+        if (small->free_list_ != 0) {
+            small->free_tail_->right = big->free_list_;
+            if (big->free_list_ == 0) {
+                big->free_tail_ = small->free_tail_;
+            }
+            big->free_list_ = small->free_list_;
+        }
+        small->blocks_ = 0;
+        small->last_block_ = 0;
+        small->block_count_ = 0;
+        small->free_list_ = 0;
+        small->free_tail_ = 0;
+        small->forward_ = big->share();
+        return big;
+    }
+
+    /**
+     * @brief Hands out a node with one reference. Its other fields are left
+     * for the caller to fill in.
+     *
+     * @return The node.
+     */
+    Node* allocate() {
+        assert(forward_ == 0);
+        if (free_list_ == 0) {
+            Block* block = new Block();
+            block->next = blocks_;
+            if (blocks_ == 0) {
+                last_block_ = block;
+            }
+            blocks_ = block;
+            ++block_count_;
+            for (int i = 0; i < BLOCK_NODES; ++i) {
+                push_free(&block->nodes[i]);
+            }
+        }
+        Node* node = free_list_;
+        free_list_ = node->right;
+        if (free_list_ == 0) {
+            free_tail_ = 0;
+        }
+        node->refs = 1;
+        return node;
+    }
+
+    // Adds a reference to node (safe on NULL).
+    static void retain(Node* node) {
+        if (node != 0) {
+            ++node->refs;
+        }
+    }
+
+    /**
+     * @brief Drops a reference to node; nodes that reach zero references go
+     * back to the free list and drop their children's references in turn.
+     *
+     * Iterative (uses the dead_ stack), since a path in the structure can be
+     * as long as the structure.
+     *
+     * @param node The node to release (safe on NULL).
+     */
+    void release(Node* node) {
+        assert(forward_ == 0);
+        if (node == 0 || --node->refs > 0) {
+            return;
+        }
+        dead_.push_back(node);
+        while (!dead_.empty()) {
+            Node* dead = dead_.back();
+            dead_.pop_back();
+            if (dead->left != 0 && --dead->left->refs == 0) {
+                dead_.push_back(dead->left);
+            }
+            if (dead->right != 0 && --dead->right->refs == 0) {
+                dead_.push_back(dead->right);
+            }
+            dead->left = 0;
+            push_free(dead);
+        }
+    }
+};
+
+#endif // REF_COUNTED_ARENA_H
@@ -0,0 +1,472 @@
+#ifndef ARENA_TREAP_H
+#define ARENA_TREAP_H
+
+// Arena-backed treap: same ordered-map API as Treap, index-based nodes.
+#include "DynamicallySizedArray.h"
+#include "TreapPriority.h"
+#include <cassert>
+
+/**
+ * ArenaTreapNode
+ * A treap node living in an ArenaTreap's node pool. Children are 32-bit
+ * indices into the pool (0 is the null sentinel) and there is no parent link,
+ * so a Treap<int,int> node shrinks from 48 to 24 bytes.
+ */
+template <typename K, typename V> struct ArenaTreapNode {
+    K key;
+    V value;
+
+    unsigned int priority; // heap key (smaller = higher priority)
+    int subtree_size;      // size of subtree rooted here (0 for the sentinel)
+
+    unsigned int left;  // Also links the free list.
+    unsigned int right;
+
+    ArenaTreapNode()
+        : key(), value(), priority(0), subtree_size(0), left(0), right(0) {}
+
+    ArenaTreapNode(const K& k, const V& v, unsigned int p)
+        : key(k), value(v), priority(p), subtree_size(1), left(0), right(0) {}
+};
+
+/**
+ * ArenaTreap
+ * A treap with the Treap<K,V> API whose nodes live in one contiguous pool
+ * (a DynamicallySizedArray) owned by the tree:
+ *  - cursors are handles (pool indices) instead of node pointers; 0 means
+ *    "no node", and a handle stays valid until its node is erased,
+ *  - without parent links every operation is top-down from the root (insert
+ *    and erase re-link through a pointer to the child slot, split and join
+ *    record their path and fix sizes on the way back),
+ *  - erased nodes go on a free list and are reused by later inserts,
+ *  - copying is one copy of the pool (handles stay valid in the copy) and
+ *    clear() is an O(1) reset instead of a per-node walk.
+ */
+template <typename K, typename V> class ArenaTreap {
+  public:
+    typedef unsigned int handle;
+
+  private:
+    typedef ArenaTreapNode<K, V> ANode;
+
+    static const handle NIL = 0;
+
+    DynamicallySizedArray<ANode> _nodes; // _nodes[0] is the null sentinel.
+    DynamicallySizedArray<handle> _path; // Scratch stack for split/join.
+    handle _root;
+    handle _free; // Head of the free list (linked through left).
+    TreapPriorities _priorities;
+
+    // Recomputes subtree_size of node from its children; the sentinel's size
+    // of 0 makes this branch-free.
+    void pull(handle node) {
+        ANode& n = _nodes[node];
+        n.subtree_size =
+            1 + _nodes[n.left].subtree_size + _nodes[n.right].subtree_size;
+    }
+
+    /**
+     * @brief Takes a node from the free list, or appends one to the pool.
+     *
+     * Must be called before taking references into _nodes, since appending
+     * may move the pool.
+     *
+     * @return Handle of the new node.
+     */
+    handle allocate(const K& key, const V& value) {
+        ANode fresh(key, value, _priorities.next());
+        if (_free != NIL) {
+            handle node = _free;
+            _free = _nodes[node].left;
+            _nodes[node] = fresh;
+            return node;
+        }
+        _nodes.push_back(fresh);
+        return static_cast<handle>(_nodes.size() - 1);
+    }
+
+    // Puts node on the free list.
+    void release(handle node) {
+        _nodes[node].left = _free;
+        _nodes[node].right = NIL;
+        _nodes[node].subtree_size = 0;
+        _free = node;
+    }
+
+    /**
+     * @brief Splits the subtree rooted at tree into keys < key and keys >=
+     * key, top-down: each visited node is hooked onto the left or right
+     * result, and the path is pulled bottom-up afterwards.
+     *
+     * @param tree Root of the subtree to split.
+     * @param key The split key.
+     * @param left_root Receives the root of the nodes with keys < key.
+     * @param right_root Receives the root of the nodes with keys >= key.
+     */
+    void split(handle tree, const K& key, handle& left_root,
+               handle& right_root) {
+        handle* left_hook = &left_root;
+        handle* right_hook = &right_root;
+        _path.resize(0);
+        while (tree != NIL) {
+            _path.push_back(tree);
+            ANode& n = _nodes[tree];
+            if (n.key < key) {
+                *left_hook = tree;
+                left_hook = &n.right;
+                tree = n.right;
+            } else {
+                *right_hook = tree;
+                right_hook = &n.left;
+                tree = n.left;
+            }
+        }
+        *left_hook = NIL;
+        *right_hook = NIL;
+        for (int i = _path.size() - 1; i >= 0; --i) {
+            pull(_path[i]);
+        }
+    }
+
+    /**
+     * @brief Joins two subtrees where every key in left_tree is smaller than
+     * every key in right_tree, top-down along the inner spines.
+     *
+     * @return Root of the joined subtree.
+     */
+    handle join(handle left_tree, handle right_tree) {
+        handle root = NIL;
+        handle* hook = &root;
+        _path.resize(0);
+        while (left_tree != NIL && right_tree != NIL) {
+            if (_nodes[left_tree].priority < _nodes[right_tree].priority) {
+                *hook = left_tree;
+                _path.push_back(left_tree);
+                hook = &_nodes[left_tree].right;
+                left_tree = *hook;
+            } else {
+                *hook = right_tree;
+                _path.push_back(right_tree);
+                hook = &_nodes[right_tree].left;
+                right_tree = *hook;
+            }
+        }
+        *hook = (left_tree != NIL) ? left_tree : right_tree;
+        for (int i = _path.size() - 1; i >= 0; --i) {
+            pull(_path[i]);
+        }
+        return root;
+    }
+
+  public:
+    // Constructor
+    ArenaTreap()
+        : _nodes(), _path(), _root(NIL), _free(NIL), _priorities() {
+        _nodes.push_back(ANode());
+    }
+
+    // Copy Constructor: one copy of the node pool.
+    ArenaTreap(const ArenaTreap& other)
+        : _nodes(other._nodes), _path(), _root(other._root),
+          _free(other._free), _priorities() {}
+
+    // Assignment operator: one copy of the node pool.
+    ArenaTreap& operator=(const ArenaTreap& other) {
+        if (this != &other) {
+            _nodes = other._nodes;
+            _root = other._root;
+            _free = other._free;
+            _priorities = other._priorities;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~ArenaTreap() {}
+
+    // Key of the node with handle node (node != 0).
+    const K& key(handle node) const {
+        assert(node != NIL);
+        return _nodes[node].key;
+    }
+
+    // Value of the node with handle node (node != 0).
+    V& value(handle node) {
+        assert(node != NIL);
+        return _nodes[node].value;
+    }
+
+    // Value of the node with handle node (node != 0).
+    const V& value(handle node) const {
+        assert(node != NIL);
+        return _nodes[node].value;
+    }
+
+    /**
+     * @brief Finds the node with the given key.
+     *
+     * @param key The key to find.
+     *
+     * @return Handle of the node with the given key, or 0 if not found.
+     */
+    handle find(const K& key) const {
+        handle current = _root;
+        while (current != NIL) {
+            const ANode& n = _nodes[current];
+            if (key < n.key) {
+                current = n.left;
+            } else if (n.key < key) {
+                current = n.right;
+            } else {
+                return current;
+            }
+        }
+        return NIL;
+    }
+
+    /**
+     * @brief Finds the node with the smallest key >= key.
+     *
+     * @param key The key to compare against.
+     *
+     * @return Handle of the first node with key >= key, or 0 if none exists.
+     */
+    handle lower_bound(const K& key) const {
+        handle current = _root;
+        handle candidate = NIL;
+        while (current != NIL) {
+            const ANode& n = _nodes[current];
+            if (n.key < key) {
+                current = n.right;
+            } else {
+                candidate = current;
+                current = n.left;
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Finds the node with the smallest key > key.
+     *
+     * @param key The key to compare against.
+     *
+     * @return Handle of the first node with key > key, or 0 if none exists.
+     */
+    handle upper_bound(const K& key) const {
+        handle current = _root;
+        handle candidate = NIL;
+        while (current != NIL) {
+            const ANode& n = _nodes[current];
+            if (key < n.key) {
+                candidate = current;
+                current = n.left;
+            } else {
+                current = n.right;
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Inserts a key-value pair, or finds the node if the key exists.
+     *
+     * Walks down while the nodes outrank the new priority (bumping their
+     * sizes), then splits the rest of that subtree around the new node.
+     *
+     * @param key The key to insert.
+     * @param value The value to insert.
+     *
+     * @return Handle of the inserted node, or of the existing node with key.
+     */
+    handle insert(const K& key, const V& value) {
+        handle existing = find(key);
+        if (existing != NIL) {
+            return existing;
+        }
+        handle fresh = allocate(key, value); // May move the pool.
+        unsigned int priority = _nodes[fresh].priority;
+        handle* link = &_root;
+        while (*link != NIL && _nodes[*link].priority <= priority) {
+            ANode& n = _nodes[*link];
+            ++n.subtree_size;
+            link = (key < n.key) ? &n.left : &n.right;
+        }
+        split(*link, key, _nodes[fresh].left, _nodes[fresh].right);
+        pull(fresh);
+        *link = fresh;
+        return fresh;
+    }
+
+    /**
+     * @brief Erases the node with handle node: walks down to it by key
+     * (shrinking the sizes on the way) and replaces it by the join of its
+     * children.
+     *
+     * @param node Handle of the node to erase (safe on 0).
+     */
+    void erase(handle node) {
+        if (node == NIL) {
+            return;
+        }
+        const K key = _nodes[node].key;
+        handle* link = &_root;
+        while (*link != node) {
+            assert(*link != NIL);
+            ANode& n = _nodes[*link];
+            --n.subtree_size;
+            link = (key < n.key) ? &n.left : &n.right;
+        }
+        *link = join(_nodes[node].left, _nodes[node].right);
+        release(node);
+    }
+
+    /**
+     * @brief Finds the node with the smallest key.
+     *
+     * @return Handle of the node with the smallest key, or 0 if empty.
+     */
+    handle front() const {
+        handle current = _root;
+        if (current == NIL) {
+            return NIL;
+        }
+        while (_nodes[current].left != NIL) {
+            current = _nodes[current].left;
+        }
+        return current;
+    }
+
+    /**
+     * @brief Finds the node with the largest key.
+     *
+     * @return Handle of the node with the largest key, or 0 if empty.
+     */
+    handle back() const {
+        handle current = _root;
+        if (current == NIL) {
+            return NIL;
+        }
+        while (_nodes[current].right != NIL) {
+            current = _nodes[current].right;
+        }
+        return current;
+    }
+
+    /**
+     * @brief Finds the in-order successor of a node (a top-down search for
+     * the first key greater than its key).
+     *
+     * @param node Handle of the node (safe on 0).
+     *
+     * @return Handle of the successor, or 0 if none exists.
+     */
+    handle successor(handle node) const {
+        if (node == NIL) {
+            return NIL;
+        }
+        return upper_bound(_nodes[node].key);
+    }
+
+    /**
+     * @brief Finds the in-order predecessor of a node (a top-down search for
+     * the last key smaller than its key).
+     *
+     * @param node Handle of the node (safe on 0).
+     *
+     * @return Handle of the predecessor, or 0 if none exists.
+     */
+    handle predecessor(handle node) const {
+        if (node == NIL) {
+            return NIL;
+        }
+        const K& key = _nodes[node].key;
+        handle current = _root;
+        handle candidate = NIL;
+        while (current != NIL) {
+            const ANode& n = _nodes[current];
+            if (n.key < key) {
+                candidate = current;
+                current = n.right;
+            } else {
+                current = n.left;
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Calculates the in-order rank of a node, counting the left
+     * subtrees passed on the way down to it.
+     *
+     * @param node Handle of the node.
+     *
+     * @return The 0-based rank of the node, or -1 if node is 0.
+     */
+    int rank(handle node) const {
+        if (node == NIL) {
+            return -1;
+        }
+        const K& key = _nodes[node].key;
+        int result = 0;
+        handle current = _root;
+        while (current != node) {
+            assert(current != NIL);
+            const ANode& n = _nodes[current];
+            if (key < n.key) {
+                current = n.left;
+            } else {
+                result += _nodes[n.left].subtree_size + 1;
+                current = n.right;
+            }
+        }
+        return result + _nodes[_nodes[node].left].subtree_size;
+    }
+
+    /**
+     * @brief Finds the k-th smallest node (0-based).
+     *
+     * @param k The rank to look up.
+     *
+     * @return Handle of the k-th node, or 0 if k is out of range.
+     */
+    handle kth(int k) const {
+        if (k < 0 || k >= size()) {
+            return NIL;
+        }
+        handle current = _root;
+        while (true) {
+            const ANode& n = _nodes[current];
+            int left_size = _nodes[n.left].subtree_size;
+            if (k < left_size) {
+                current = n.left;
+            } else if (k == left_size) {
+                return current;
+            } else {
+                k -= left_size + 1;
+                current = n.right;
+            }
+        }
+    }
+
+    /**
+     * @brief Provides the number of nodes in the treap. O(1).
+     *
+     * @return The number of nodes in the treap.
+     */
+    int size() const {
+        return _nodes[_root].subtree_size;
+    }
+
+    /**
+     * @brief Removes every node by resetting the pool to the sentinel. O(1);
+     * all handles into this treap become invalid.
+     */
+    void clear() {
+        _nodes.resize(1);
+        _root = NIL;
+        _free = NIL;
+    }
+};
+
+#endif // ARENA_TREAP_H
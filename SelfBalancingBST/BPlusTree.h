@@ -0,0 +1,850 @@
+#ifndef B_PLUS_TREE_H
+#define B_PLUS_TREE_H
+
+// Cache-conscious B+-tree ordered map with the Treap API.
+#include <cassert>
+
+// Maximum keys per leaf and children per inner node. Nodes below the root
+// hold at least half of that.
+static const int BPLUS_CAPACITY = 32;
+static const int BPLUS_MIN_FILL = BPLUS_CAPACITY / 2;
+// Deep enough for any int-sized tree (minimum fanout 16 at every level).
+static const int BPLUS_MAX_HEIGHT = 16;
+
+/**
+ * BPlusTreeNode
+ * Common header of leaves and inner nodes. count is the number of entries in
+ * a leaf, or the number of children of an inner node.
+ */
+struct BPlusTreeNode {
+    bool is_leaf;
+    int count;
+
+    explicit BPlusTreeNode(bool leaf) : is_leaf(leaf), count(0) {}
+};
+
+/**
+ * BPlusTreeLeaf
+ * Holds up to BPLUS_CAPACITY sorted entries; leaves are doubly linked in key
+ * order.
+ */
+template <typename K, typename V> struct BPlusTreeLeaf : BPlusTreeNode {
+    K keys[BPLUS_CAPACITY];
+    V values[BPLUS_CAPACITY];
+    BPlusTreeLeaf* prev;
+    BPlusTreeLeaf* next;
+
+    BPlusTreeLeaf() : BPlusTreeNode(true), prev(0), next(0) {}
+};
+
+/**
+ * BPlusTreeInner
+ * Holds count children and count - 1 separators: every key in children[i]
+ * is < keys[i] <= every key in children[i + 1]. sizes[i] is the number of
+ * entries under children[i], for kth() and rank().
+ */
+template <typename K> struct BPlusTreeInner : BPlusTreeNode {
+    K keys[BPLUS_CAPACITY - 1];
+    BPlusTreeNode* children[BPLUS_CAPACITY];
+    int sizes[BPLUS_CAPACITY];
+
+    BPlusTreeInner() : BPlusTreeNode(false) {}
+};
+
+template <typename K, typename V> class BPlusTree;
+
+/**
+ * BPlusTreeCursor
+ * A position (leaf, index) in a BPlusTree, plus the entry's key and the
+ * tree's version when the position was taken; the unset cursor has no leaf.
+ * Entries move between leaves when the tree changes shape, so once the tree
+ * has changed the cursor finds its entry again by key (O(log n), once per
+ * change). A cursor thus survives inserts and erases of other keys; if its
+ * own entry was erased it becomes unset.
+ */
+template <typename K, typename V> struct BPlusTreeCursor {
+    mutable BPlusTreeLeaf<K, V>* leaf;
+    mutable int index;
+    mutable unsigned long version; // The tree's version at leaf / index.
+    const BPlusTree<K, V>* tree;
+    K entry_key;
+
+    BPlusTreeCursor() : leaf(0), index(0), version(0), tree(0), entry_key() {}
+    BPlusTreeCursor(const BPlusTree<K, V>* t, BPlusTreeLeaf<K, V>* l, int i)
+        : leaf(l), index(i), version(t->version()), tree(t),
+          entry_key(l->keys[i]) {}
+
+    // Re-finds the entry by key if the tree changed since leaf / index were
+    // taken. O(1) if it did not, O(log n) otherwise.
+    void refresh() const;
+
+    // Whether the cursor points at an entry.
+    bool is_set() const {
+        refresh();
+        return leaf != 0;
+    }
+
+    // Key of the entry (the cursor must be set).
+    const K& key() const {
+        assert(is_set());
+        return entry_key;
+    }
+
+    // Value of the entry (the cursor must be set); may be assigned to.
+    V& value() const {
+        assert(is_set());
+        return leaf->values[index];
+    }
+};
+
+/**
+ * BPlusTree
+ * An ordered map with the Treap<K,V> operation set on a B+-tree: entries
+ * live in wide leaves (BPLUS_CAPACITY sorted keys, then the values), inner
+ * nodes hold only separators, child pointers and per-child entry counts.
+ * A lookup touches O(log_16 n) nodes and scans a few contiguous keys in each,
+ * instead of following ~2.5 log2 n pointers to one-key nodes.
+ *
+ *  - successor / predecessor follow the leaf links, O(1),
+ *  - kth descends by the per-child counts, rank sums them on the way down,
+ *  - insert splits full nodes and erase borrows from or merges with a
+ *    sibling, both bottom-up along the recorded search path.
+ *
+ * Cursors are BPlusTreeCursor (leaf, index) positions instead of node
+ * pointers. Every insert or erase bumps the tree's version, and a cursor
+ * taken before that re-finds its entry by key on its next use.
+ */
+template <typename K, typename V> class BPlusTree {
+  public:
+    typedef BPlusTreeCursor<K, V> cursor;
+
+  private:
+    friend struct BPlusTreeCursor<K, V>;
+    typedef BPlusTreeNode Node;
+    typedef BPlusTreeLeaf<K, V> Leaf;
+    typedef BPlusTreeInner<K> Inner;
+
+    Node* _root; // NULL when empty.
+    int _size;
+    unsigned long _version; // Bumped whenever entries may have moved.
+
+    // Number of keys in keys[0..n) that are < key (binary search).
+    static int count_less(const K* keys, int n, const K& key) {
+        int lo = 0;
+        while (n > 0) {
+            int half = n / 2;
+            if (keys[lo + half] < key) {
+                lo += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        return lo;
+    }
+
+    // Number of keys in keys[0..n) that are <= key (binary search).
+    static int count_not_greater(const K* keys, int n, const K& key) {
+        int lo = 0;
+        while (n > 0) {
+            int half = n / 2;
+            if (!(key < keys[lo + half])) {
+                lo += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Walks from the root to the leaf whose key range holds key.
+     *
+     * @param key The key to look for.
+     * @param path Receives the inner nodes passed (may be NULL).
+     * @param slots Receives the child slot taken in each (may be NULL).
+     * @param depth Receives the number of inner nodes passed.
+     *
+     * @return The leaf (the tree must not be empty).
+     */
+    Leaf* descend(const K& key, Inner** path, int* slots, int& depth) const {
+        Node* node = _root;
+        depth = 0;
+        while (!node->is_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            int slot = count_not_greater(inner->keys, inner->count - 1, key);
+            if (path != 0) {
+                path[depth] = inner;
+                slots[depth] = slot;
+            }
+            ++depth;
+            node = inner->children[slot];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // Cursor at position pos of leaf, moving on to the next leaf when pos is
+    // past the end.
+    cursor normalize(Leaf* leaf, int pos) const {
+        if (pos < leaf->count) {
+            return cursor(this, leaf, pos);
+        }
+        return (leaf->next == 0) ? cursor() : cursor(this, leaf->next, 0);
+    }
+
+    // Points a cursor taken at an older version back at its entry (or
+    // unsets it if the entry is gone). O(log n).
+    void relocate(const cursor& position) const {
+        position.leaf = 0;
+        position.index = 0;
+        position.version = _version;
+        if (_root == 0) {
+            return;
+        }
+        int depth;
+        Leaf* leaf = descend(position.entry_key, 0, 0, depth);
+        int pos = count_less(leaf->keys, leaf->count, position.entry_key);
+        if (pos < leaf->count && !(position.entry_key < leaf->keys[pos])) {
+            position.leaf = leaf;
+            position.index = pos;
+        }
+    }
+
+    static void insert_into_leaf(Leaf* leaf, int pos, const K& key,
+                                 const V& value) {
+        for (int i = leaf->count; i > pos; --i) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->values[i] = leaf->values[i - 1];
+        }
+        leaf->keys[pos] = key;
+        leaf->values[pos] = value;
+        ++leaf->count;
+    }
+
+    static void remove_from_leaf(Leaf* leaf, int pos) {
+        for (int i = pos + 1; i < leaf->count; ++i) {
+            leaf->keys[i - 1] = leaf->keys[i];
+            leaf->values[i - 1] = leaf->values[i];
+        }
+        --leaf->count;
+    }
+
+    static int total_size(Inner* inner) {
+        int total = 0;
+        for (int i = 0; i < inner->count; ++i) {
+            total += inner->sizes[i];
+        }
+        return total;
+    }
+
+    static int node_size(Node* node) {
+        return node->is_leaf ? node->count
+                             : total_size(static_cast<Inner*>(node));
+    }
+
+    /**
+     * @brief Hangs right (holding right_size entries) next to left, which
+     * has just been split off from it, in left's parent, splitting full
+     * parents on the way up.
+     *
+     * The per-child counts on the path already include the new entry; only
+     * the split child's count is divided between left and right.
+     *
+     * @param path Inner nodes from the root down to left's parent.
+     * @param slots Slot of the path's next node in each path node.
+     * @param depth Number of nodes in path (0: left is the root).
+     * @param left The node that was split.
+     * @param separator Smallest key under right.
+     * @param right The new right sibling of left.
+     * @param left_size Entries under left.
+     * @param right_size Entries under right.
+     */
+    void insert_child(Inner** path, int* slots, int depth, Node* left,
+                      K separator, Node* right, int left_size,
+                      int right_size) {
+        while (depth > 0) {
+            Inner* parent = path[depth - 1];
+            int slot = slots[depth - 1];
+            parent->sizes[slot] = left_size;
+            if (parent->count < BPLUS_CAPACITY) {
+                for (int i = parent->count; i > slot + 1; --i) {
+                    parent->children[i] = parent->children[i - 1];
+                    parent->sizes[i] = parent->sizes[i - 1];
+                }
+                for (int i = parent->count - 1; i > slot; --i) {
+                    parent->keys[i] = parent->keys[i - 1];
+                }
+                parent->children[slot + 1] = right;
+                parent->sizes[slot + 1] = right_size;
+                parent->keys[slot] = separator;
+                ++parent->count;
+                return;
+            }
+
+            // Full: lay out the BPLUS_CAPACITY + 1 children and split them.
+            Node* children[BPLUS_CAPACITY + 1];
+            int sizes[BPLUS_CAPACITY + 1];
+            K keys[BPLUS_CAPACITY];
+            for (int i = 0, j = 0; i <= BPLUS_CAPACITY; ++i) {
+                if (i == slot + 1) {
+                    children[i] = right;
+                    sizes[i] = right_size;
+                } else {
+                    children[i] = parent->children[j];
+                    sizes[i] = parent->sizes[j];
+                    ++j;
+                }
+            }
+            for (int i = 0, j = 0; i < BPLUS_CAPACITY; ++i) {
+                keys[i] = (i == slot) ? separator : parent->keys[j++];
+            }
+
+            int left_count = (BPLUS_CAPACITY + 1) / 2;
+            Inner* sibling = new Inner();
+            parent->count = left_count;
+            sibling->count = BPLUS_CAPACITY + 1 - left_count;
+            left_size = 0;
+            right_size = 0;
+            for (int i = 0; i < left_count; ++i) {
+                parent->children[i] = children[i];
+                parent->sizes[i] = sizes[i];
+                left_size += sizes[i];
+            }
+            for (int i = 0; i + 1 < left_count; ++i) {
+                parent->keys[i] = keys[i];
+            }
+            for (int i = 0; i < sibling->count; ++i) {
+                sibling->children[i] = children[left_count + i];
+                sibling->sizes[i] = sizes[left_count + i];
+                right_size += sizes[left_count + i];
+            }
+            for (int i = 0; i + 1 < sibling->count; ++i) {
+                sibling->keys[i] = keys[left_count + i];
+            }
+
+            left = parent;
+            separator = keys[left_count - 1]; // Moves up, not copied.
+            right = sibling;
+            --depth;
+        }
+
+        // left was the root: grow the tree by one level.
+        Inner* root = new Inner();
+        root->count = 2;
+        root->children[0] = left;
+        root->children[1] = right;
+        root->sizes[0] = left_size;
+        root->sizes[1] = right_size;
+        root->keys[0] = separator;
+        _root = root;
+    }
+
+    // Removes child slot + 1 and separator slot from parent.
+    static void remove_child(Inner* parent, int slot) {
+        for (int i = slot + 1; i + 1 < parent->count; ++i) {
+            parent->children[i] = parent->children[i + 1];
+            parent->sizes[i] = parent->sizes[i + 1];
+        }
+        for (int i = slot; i + 2 < parent->count; ++i) {
+            parent->keys[i] = parent->keys[i + 1];
+        }
+        --parent->count;
+    }
+
+    /**
+     * @brief Restores the minimum fill of an underfull leaf by borrowing an
+     * entry from a sibling, or by merging with it.
+     *
+     * @return true if a merge removed a child from the leaf's parent.
+     */
+    static bool rebalance_leaf(Leaf* leaf, Inner* parent, int slot) {
+        if (slot > 0) {
+            Leaf* left = static_cast<Leaf*>(parent->children[slot - 1]);
+            if (left->count > BPLUS_MIN_FILL) {
+                insert_into_leaf(leaf, 0, left->keys[left->count - 1],
+                                 left->values[left->count - 1]);
+                --left->count;
+                parent->keys[slot - 1] = leaf->keys[0];
+                --parent->sizes[slot - 1];
+                ++parent->sizes[slot];
+                return false;
+            }
+            merge_leaves(left, leaf, parent, slot - 1);
+            return true;
+        }
+        Leaf* right = static_cast<Leaf*>(parent->children[slot + 1]);
+        if (right->count > BPLUS_MIN_FILL) {
+            insert_into_leaf(leaf, leaf->count, right->keys[0],
+                             right->values[0]);
+            remove_from_leaf(right, 0);
+            parent->keys[slot] = right->keys[0];
+            ++parent->sizes[slot];
+            --parent->sizes[slot + 1];
+            return false;
+        }
+        merge_leaves(leaf, right, parent, slot);
+        return true;
+    }
+
+    // Appends right (children[slot + 1]) to left (children[slot]) and frees
+    // it.
+    static void merge_leaves(Leaf* left, Leaf* right, Inner* parent,
+                             int slot) {
+        for (int i = 0; i < right->count; ++i) {
+            left->keys[left->count + i] = right->keys[i];
+            left->values[left->count + i] = right->values[i];
+        }
+        left->count += right->count;
+        left->next = right->next;
+        if (right->next != 0) {
+            right->next->prev = left;
+        }
+        parent->sizes[slot] += parent->sizes[slot + 1];
+        remove_child(parent, slot);
+        delete right;
+    }
+
+    /**
+     * @brief Restores the minimum fill of an underfull inner node, rotating
+     * a child through the parent from a sibling, or merging with it (the
+     * parent's separator moves down between the two).
+     *
+     * @return true if a merge removed a child from the node's parent.
+     */
+    static bool rebalance_inner(Inner* node, Inner* parent, int slot) {
+        if (slot > 0) {
+            Inner* left = static_cast<Inner*>(parent->children[slot - 1]);
+            if (left->count > BPLUS_MIN_FILL) {
+                for (int i = node->count; i > 0; --i) {
+                    node->children[i] = node->children[i - 1];
+                    node->sizes[i] = node->sizes[i - 1];
+                }
+                for (int i = node->count - 1; i > 0; --i) {
+                    node->keys[i] = node->keys[i - 1];
+                }
+                int moved = left->sizes[left->count - 1];
+                node->children[0] = left->children[left->count - 1];
+                node->sizes[0] = moved;
+                node->keys[0] = parent->keys[slot - 1];
+                parent->keys[slot - 1] = left->keys[left->count - 2];
+                ++node->count;
+                --left->count;
+                parent->sizes[slot - 1] -= moved;
+                parent->sizes[slot] += moved;
+                return false;
+            }
+            merge_inner(left, node, parent, slot - 1);
+            return true;
+        }
+        Inner* right = static_cast<Inner*>(parent->children[slot + 1]);
+        if (right->count > BPLUS_MIN_FILL) {
+            int moved = right->sizes[0];
+            node->children[node->count] = right->children[0];
+            node->sizes[node->count] = moved;
+            node->keys[node->count - 1] = parent->keys[slot];
+            parent->keys[slot] = right->keys[0];
+            ++node->count;
+            for (int i = 1; i < right->count; ++i) {
+                right->children[i - 1] = right->children[i];
+                right->sizes[i - 1] = right->sizes[i];
+            }
+            for (int i = 1; i + 1 < right->count; ++i) {
+                right->keys[i - 1] = right->keys[i];
+            }
+            --right->count;
+            parent->sizes[slot] += moved;
+            parent->sizes[slot + 1] -= moved;
+            return false;
+        }
+        merge_inner(node, right, parent, slot);
+        return true;
+    }
+
+    // Appends right (children[slot + 1]) to left (children[slot]), with the
+    // parent's separator between them, and frees it.
+    static void merge_inner(Inner* left, Inner* right, Inner* parent,
+                            int slot) {
+        left->keys[left->count - 1] = parent->keys[slot];
+        for (int i = 0; i < right->count; ++i) {
+            left->children[left->count + i] = right->children[i];
+            left->sizes[left->count + i] = right->sizes[i];
+        }
+        for (int i = 0; i + 1 < right->count; ++i) {
+            left->keys[left->count + i] = right->keys[i];
+        }
+        left->count += right->count;
+        parent->sizes[slot] += parent->sizes[slot + 1];
+        remove_child(parent, slot);
+        delete right;
+    }
+
+    static void destroy_subtree(Node* node) {
+        if (node == 0) {
+            return;
+        }
+        if (node->is_leaf) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (int i = 0; i < inner->count; ++i) {
+            destroy_subtree(inner->children[i]);
+        }
+        delete inner;
+    }
+
+    /**
+     * @brief Deep-copies a subtree, linking the copied leaves in order.
+     *
+     * @param node The subtree to copy (may be NULL).
+     * @param last_leaf The last copied leaf so far; advanced.
+     *
+     * @return The copy.
+     */
+    static Node* clone_subtree(Node* node, Leaf*& last_leaf) {
+        if (node == 0) {
+            return 0;
+        }
+        if (node->is_leaf) {
+            Leaf* copy = new Leaf(*static_cast<Leaf*>(node));
+            copy->prev = last_leaf;
+            copy->next = 0;
+            if (last_leaf != 0) {
+                last_leaf->next = copy;
+            }
+            last_leaf = copy;
+            return copy;
+        }
+        Inner* copy = new Inner(*static_cast<Inner*>(node));
+        for (int i = 0; i < copy->count; ++i) {
+            copy->children[i] = clone_subtree(copy->children[i], last_leaf);
+        }
+        return copy;
+    }
+
+  public:
+    // Constructor
+    BPlusTree() : _root(0), _size(0), _version(0) {}
+
+    // Copy Constructor
+    BPlusTree(const BPlusTree& other)
+        : _root(0), _size(other._size), _version(0) {
+        Leaf* last_leaf = 0;
+        _root = clone_subtree(other._root, last_leaf);
+    }
+
+    // Assignment operator
+    BPlusTree& operator=(const BPlusTree& other) {
+        if (this != &other) {
+            clear();
+            Leaf* last_leaf = 0;
+            _root = clone_subtree(other._root, last_leaf);
+            _size = other._size;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~BPlusTree() {
+        clear();
+    }
+
+    // Returns number of entries.
+    int size() const {
+        return _size;
+    }
+
+    // Removes all entries.
+    void clear() {
+        destroy_subtree(_root);
+        _root = 0;
+        _size = 0;
+        ++_version;
+    }
+
+    // Changes whenever entries may have moved (any insert, erase, clear or
+    // assignment); cursors compare it to tell whether to re-find their entry.
+    unsigned long version() const {
+        return _version;
+    }
+
+    /**
+     * @brief Finds the entry with the given key. O(log n).
+     *
+     * @return A cursor at the entry, or an unset cursor if not found.
+     */
+    cursor find(const K& key) const {
+        if (_root == 0) {
+            return cursor();
+        }
+        int depth;
+        Leaf* leaf = descend(key, 0, 0, depth);
+        int pos = count_less(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !(key < leaf->keys[pos])) {
+            return cursor(this, leaf, pos);
+        }
+        return cursor();
+    }
+
+    /**
+     * @brief Finds the first entry with key >= key. O(log n).
+     *
+     * @return A cursor at the entry, or an unset cursor if none exists.
+     */
+    cursor lower_bound(const K& key) const {
+        if (_root == 0) {
+            return cursor();
+        }
+        int depth;
+        Leaf* leaf = descend(key, 0, 0, depth);
+        return normalize(leaf, count_less(leaf->keys, leaf->count, key));
+    }
+
+    /**
+     * @brief Finds the first entry with key > key. O(log n).
+     *
+     * @return A cursor at the entry, or an unset cursor if none exists.
+     */
+    cursor upper_bound(const K& key) const {
+        if (_root == 0) {
+            return cursor();
+        }
+        int depth;
+        Leaf* leaf = descend(key, 0, 0, depth);
+        return normalize(leaf,
+                         count_not_greater(leaf->keys, leaf->count, key));
+    }
+
+    /**
+     * @brief Inserts a key-value pair, or finds the entry if the key exists.
+     * O(log n); a full leaf is split in two and the split may propagate up.
+     *
+     * @return A cursor at the inserted (or existing) entry.
+     */
+    cursor insert(const K& key, const V& value) {
+        if (_root == 0) {
+            Leaf* leaf = new Leaf();
+            insert_into_leaf(leaf, 0, key, value);
+            _root = leaf;
+            _size = 1;
+            ++_version;
+            return cursor(this, leaf, 0);
+        }
+        Inner* path[BPLUS_MAX_HEIGHT];
+        int slots[BPLUS_MAX_HEIGHT];
+        int depth;
+        Leaf* leaf = descend(key, path, slots, depth);
+        int pos = count_less(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !(key < leaf->keys[pos])) {
+            return cursor(this, leaf, pos);
+        }
+
+        ++_size;
+        ++_version;
+        for (int d = 0; d < depth; ++d) {
+            ++path[d]->sizes[slots[d]];
+        }
+        if (leaf->count < BPLUS_CAPACITY) {
+            insert_into_leaf(leaf, pos, key, value);
+            return cursor(this, leaf, pos);
+        }
+
+        // Split the full leaf in half, then insert into the proper half.
+        Leaf* right = new Leaf();
+        int keep = BPLUS_CAPACITY - BPLUS_CAPACITY / 2;
+        right->count = BPLUS_CAPACITY - keep;
+        for (int i = 0; i < right->count; ++i) {
+            right->keys[i] = leaf->keys[keep + i];
+            right->values[i] = leaf->values[keep + i];
+        }
+        leaf->count = keep;
+        right->next = leaf->next;
+        if (right->next != 0) {
+            right->next->prev = right;
+        }
+        right->prev = leaf;
+        leaf->next = right;
+
+        cursor result;
+        if (pos <= keep) {
+            insert_into_leaf(leaf, pos, key, value);
+            result = cursor(this, leaf, pos);
+        } else {
+            insert_into_leaf(right, pos - keep, key, value);
+            result = cursor(this, right, pos - keep);
+        }
+        insert_child(path, slots, depth, leaf, right->keys[0], right,
+                     leaf->count, right->count);
+        return result;
+    }
+
+    /**
+     * @brief Erases the entry at a cursor. O(log n); an underfull node
+     * borrows from or merges with a sibling, which may propagate up.
+     *
+     * @param position A cursor into this tree (safe if unset).
+     */
+    void erase(const cursor& position) {
+        if (!position.is_set()) {
+            return;
+        }
+        Inner* path[BPLUS_MAX_HEIGHT];
+        int slots[BPLUS_MAX_HEIGHT];
+        int depth;
+        Leaf* leaf = descend(position.key(), path, slots, depth);
+        assert(leaf == position.leaf);
+        remove_from_leaf(leaf, position.index);
+        --_size;
+        ++_version;
+        for (int d = 0; d < depth; ++d) {
+            --path[d]->sizes[slots[d]];
+        }
+
+        if (depth == 0) {
+            if (leaf->count == 0) {
+                delete leaf;
+                _root = 0;
+            }
+            return;
+        }
+        if (leaf->count >= BPLUS_MIN_FILL ||
+            !rebalance_leaf(leaf, path[depth - 1], slots[depth - 1])) {
+            return;
+        }
+        // A merge removed a child: the parents may be underfull now.
+        for (int d = depth - 1; d > 0; --d) {
+            if (path[d]->count >= BPLUS_MIN_FILL ||
+                !rebalance_inner(path[d], path[d - 1], slots[d - 1])) {
+                return;
+            }
+        }
+        Inner* root = path[0];
+        if (root->count == 1) {
+            _root = root->children[0];
+            delete root;
+        }
+    }
+
+    /**
+     * @brief Finds the entry with the smallest key. O(log n).
+     *
+     * @return A cursor at it, or an unset cursor if empty.
+     */
+    cursor front() const {
+        if (_root == 0) {
+            return cursor();
+        }
+        Node* node = _root;
+        while (!node->is_leaf) {
+            node = static_cast<Inner*>(node)->children[0];
+        }
+        return cursor(this, static_cast<Leaf*>(node), 0);
+    }
+
+    /**
+     * @brief Finds the entry with the largest key. O(log n).
+     *
+     * @return A cursor at it, or an unset cursor if empty.
+     */
+    cursor back() const {
+        if (_root == 0) {
+            return cursor();
+        }
+        Node* node = _root;
+        while (!node->is_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            node = inner->children[inner->count - 1];
+        }
+        return cursor(this, static_cast<Leaf*>(node), node->count - 1);
+    }
+
+    /**
+     * @brief The next entry in key order, through the leaf links. O(1).
+     *
+     * @param position The cursor (safe if unset).
+     *
+     * @return A cursor at the successor, or an unset cursor if none exists.
+     */
+    cursor successor(const cursor& position) const {
+        if (!position.is_set()) {
+            return cursor();
+        }
+        return normalize(position.leaf, position.index + 1);
+    }
+
+    /**
+     * @brief The previous entry in key order, through the leaf links. O(1).
+     *
+     * @param position The cursor (safe if unset).
+     *
+     * @return A cursor at the predecessor, or an unset cursor if none exists.
+     */
+    cursor predecessor(const cursor& position) const {
+        if (!position.is_set()) {
+            return cursor();
+        }
+        if (position.index > 0) {
+            return cursor(this, position.leaf, position.index - 1);
+        }
+        Leaf* prev = position.leaf->prev;
+        return (prev == 0) ? cursor() : cursor(this, prev, prev->count - 1);
+    }
+
+    /**
+     * @brief The in-order rank of the entry at a cursor: the counts of the
+     * children left of the search path, plus the index in the leaf.
+     * O(log n).
+     *
+     * @return The 0-based rank, or -1 if the cursor is unset.
+     */
+    int rank(const cursor& position) const {
+        if (!position.is_set()) {
+            return -1;
+        }
+        const K& key = position.key();
+        int result = 0;
+        Node* node = _root;
+        while (!node->is_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            int slot = count_not_greater(inner->keys, inner->count - 1, key);
+            for (int i = 0; i < slot; ++i) {
+                result += inner->sizes[i];
+            }
+            node = inner->children[slot];
+        }
+        return result + position.index;
+    }
+
+    /**
+     * @brief Finds the k-th smallest entry (0-based) by descending on the
+     * per-child counts. O(log n).
+     *
+     * @return A cursor at it, or an unset cursor if k is out of range.
+     */
+    cursor kth(int k) const {
+        if (k < 0 || k >= _size) {
+            return cursor();
+        }
+        Node* node = _root;
+        while (!node->is_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            int slot = 0;
+            while (k >= inner->sizes[slot]) {
+                k -= inner->sizes[slot];
+                ++slot;
+            }
+            node = inner->children[slot];
+        }
+        return cursor(this, static_cast<Leaf*>(node), k);
+    }
+};
+
+template <typename K, typename V>
+void BPlusTreeCursor<K, V>::refresh() const {
+    if (tree != 0 && version != tree->version()) {
+        tree->relocate(*this);
+    }
+}
+
+#endif // B_PLUS_TREE_H
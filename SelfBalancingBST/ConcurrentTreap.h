@@ -0,0 +1,558 @@
+#ifndef CONCURRENT_TREAP_H
+#define CONCURRENT_TREAP_H
+
+// Treap with lock-free readers: copy-on-write updates, epoch reclamation.
+#include "DynamicallySizedArray.h"
+#include "TreapPriority.h"
+#include <cassert>
+#include <cstddef>
+#include <pthread.h>
+
+#if !defined(__GNUC__)
+#error "ConcurrentTreap needs the GCC/Clang __atomic builtins"
+#endif
+
+/**
+ * ConcurrentTreapNode
+ * A treap node. Nodes reachable from a published root are never modified:
+ * a writer copies them first (unless the copy was made by the same write,
+ * which version identifies).
+ */
+template <typename K, typename V> struct ConcurrentTreapNode {
+    K key;
+    V value;
+
+    unsigned int priority; // heap key (smaller = higher priority)
+    int subtree_size;      // size of subtree rooted here
+    unsigned long version; // The write that created this node.
+
+    ConcurrentTreapNode* left;
+    ConcurrentTreapNode* right;
+
+    ConcurrentTreapNode(const K& k, const V& v, unsigned int p,
+                        unsigned long write_version)
+        : key(k), value(v), priority(p), subtree_size(1),
+          version(write_version), left(0), right(0) {}
+};
+
+template <typename K, typename V> class ConcurrentTreapReader;
+
+/**
+ * ConcurrentTreap
+ * An ordered map for many reader threads and one writer at a time.
+ *
+ *  - Readers (ConcurrentTreapReader, one per thread) take no locks: they
+ *    load the current root and search an immutable snapshot.
+ *  - A write copies the nodes on its path (split / join spines included),
+ *    links the copies into a new root and publishes it with one atomic
+ *    store, so readers see either the old or the new tree. Writers are
+ *    serialized by a mutex.
+ *  - The replaced nodes cannot be freed while a reader may still be in the
+ *    old tree. Each reader announces the global epoch while it reads; a
+ *    replaced node is tagged with the epoch of its write and freed once
+ *    every active reader has announced a later epoch.
+ *
+ * Reads and writes are expected O(log n); a write allocates O(log n) nodes.
+ * At most MAX_READERS readers can be registered at a time.
+ */
+template <typename K, typename V> class ConcurrentTreap {
+  public:
+    static const int MAX_READERS = 64;
+    static const int CACHE_LINE = 64;
+
+  private:
+    friend class ConcurrentTreapReader<K, V>;
+    typedef ConcurrentTreapNode<K, V> CNode;
+
+    // One reader's announced epoch (0 = not reading), one cache line long.
+    // The slots start on a line boundary (see _readers), so readers do not
+    // slow each other down.
+    struct ReaderSlot {
+        unsigned long epoch;
+        int in_use;
+        char padding[CACHE_LINE - sizeof(unsigned long) - sizeof(int)];
+    };
+
+    // A replaced node and the epoch it was replaced in.
+    struct RetiredNode {
+        CNode* node;
+        unsigned long epoch;
+    };
+
+    // Retired nodes are scanned for freeing once this many have piled up.
+    static const int RECLAIM_BATCH = 1024;
+
+    // _root and _epoch are read by every reader and stored by every write;
+    // the padding keeps them off the lines of the other members, whatever
+    // the object's alignment.
+    char _padding_before[CACHE_LINE];
+    CNode* _root;            // Published with atomic stores.
+    unsigned long _epoch;    // Global epoch, starts at 1.
+    char _padding_after[CACHE_LINE];
+
+    // The reader slots: MAX_READERS line-aligned slots carved out of
+    // _reader_storage, which has one spare line for the alignment.
+    char _reader_storage[(MAX_READERS + 1) * CACHE_LINE];
+    ReaderSlot* _readers;
+    pthread_mutex_t _writer_mutex;
+
+    // Writer state (guarded by _writer_mutex).
+    unsigned long _version;          // Current write.
+    TreapPriorities _priorities;     // Priorities of new nodes.
+    DynamicallySizedArray<RetiredNode> _retired; // Oldest first.
+    int _reclaim_at;
+
+    // Not copyable: readers hold pointers into it.
+    ConcurrentTreap(const ConcurrentTreap&);
+    ConcurrentTreap& operator=(const ConcurrentTreap&);
+
+    static int get_subtree_size(CNode* tree_node) {
+        return (tree_node == 0) ? 0 : tree_node->subtree_size;
+    }
+
+    static void pull(CNode* node) {
+        node->subtree_size = 1 + get_subtree_size(node->left) +
+                             get_subtree_size(node->right);
+    }
+
+    CNode* load_root() const {
+        return __atomic_load_n(&_root, __ATOMIC_SEQ_CST);
+    }
+
+    // Queues a node of the published tree for freeing.
+    void retire(CNode* node) {
+        RetiredNode retired;
+        retired.node = node;
+        retired.epoch = _epoch;
+        _retired.push_back(retired);
+    }
+
+    /**
+     * @brief Returns a node the current write may modify: the node itself if
+     * this write created it, otherwise a copy (and the original is retired).
+     */
+    CNode* writable(CNode* node) {
+        if (node->version == _version) {
+            return node;
+        }
+        CNode* copy = new CNode(*node);
+        copy->version = _version;
+        retire(node);
+        return copy;
+    }
+
+    /**
+     * @brief Splits a subtree by key, copying the nodes on the split path.
+     *
+     * @param left_root Receives the keys < key.
+     * @param right_root Receives the keys >= key.
+     */
+    void split_nodes(CNode* tree_node, const K& key, CNode*& left_root,
+                     CNode*& right_root) {
+        if (tree_node == 0) {
+            left_root = 0;
+            right_root = 0;
+            return;
+        }
+        tree_node = writable(tree_node);
+        if (tree_node->key < key) {
+            split_nodes(tree_node->right, key, tree_node->right, right_root);
+            left_root = tree_node;
+        } else {
+            split_nodes(tree_node->left, key, left_root, tree_node->left);
+            right_root = tree_node;
+        }
+        pull(tree_node);
+    }
+
+    /**
+     * @brief Joins two subtrees (all keys of left_root smaller), copying
+     * the nodes on the two inner spines.
+     */
+    CNode* join_nodes(CNode* left_root, CNode* right_root) {
+        if (left_root == 0) {
+            return right_root;
+        }
+        if (right_root == 0) {
+            return left_root;
+        }
+        if (left_root->priority < right_root->priority) {
+            left_root = writable(left_root);
+            left_root->right = join_nodes(left_root->right, right_root);
+            pull(left_root);
+            return left_root;
+        }
+        right_root = writable(right_root);
+        right_root->left = join_nodes(left_root, right_root->left);
+        pull(right_root);
+        return right_root;
+    }
+
+    /**
+     * @brief Inserts fresh (a new node whose key is not in the subtree):
+     * copies the path down to where fresh's priority belongs, then splits
+     * the rest below fresh.
+     */
+    CNode* insert_node(CNode* tree_node, CNode* fresh) {
+        if (tree_node == 0) {
+            return fresh;
+        }
+        if (fresh->priority < tree_node->priority) {
+            split_nodes(tree_node, fresh->key, fresh->left, fresh->right);
+            pull(fresh);
+            return fresh;
+        }
+        tree_node = writable(tree_node);
+        if (fresh->key < tree_node->key) {
+            tree_node->left = insert_node(tree_node->left, fresh);
+        } else {
+            tree_node->right = insert_node(tree_node->right, fresh);
+        }
+        pull(tree_node);
+        return tree_node;
+    }
+
+    /**
+     * @brief Removes the node with key (which must be in the subtree),
+     * copying the path to it and replacing it with the join of its children.
+     */
+    CNode* erase_node(CNode* tree_node, const K& key) {
+        if (key < tree_node->key) {
+            tree_node = writable(tree_node);
+            tree_node->left = erase_node(tree_node->left, key);
+        } else if (tree_node->key < key) {
+            tree_node = writable(tree_node);
+            tree_node->right = erase_node(tree_node->right, key);
+        } else {
+            CNode* joined = join_nodes(tree_node->left, tree_node->right);
+            retire(tree_node);
+            return joined;
+        }
+        pull(tree_node);
+        return tree_node;
+    }
+
+    // Copies the path to key (which must be in the subtree) and sets its
+    // value.
+    CNode* set_value_node(CNode* tree_node, const K& key, const V& value) {
+        tree_node = writable(tree_node);
+        if (key < tree_node->key) {
+            tree_node->left = set_value_node(tree_node->left, key, value);
+        } else if (tree_node->key < key) {
+            tree_node->right = set_value_node(tree_node->right, key, value);
+        } else {
+            tree_node->value = value;
+        }
+        return tree_node;
+    }
+
+    static CNode* find_node(CNode* tree_node, const K& key) {
+        while (tree_node != 0) {
+            if (key < tree_node->key) {
+                tree_node = tree_node->left;
+            } else if (tree_node->key < key) {
+                tree_node = tree_node->right;
+            } else {
+                return tree_node;
+            }
+        }
+        return 0;
+    }
+
+    // Retires every node of a subtree (used by clear()).
+    void retire_subtree(CNode* tree_node) {
+        if (tree_node == 0) {
+            return;
+        }
+        retire_subtree(tree_node->left);
+        retire_subtree(tree_node->right);
+        retire(tree_node);
+    }
+
+    static void destroy_subtree(CNode* tree_node) {
+        if (tree_node == 0) {
+            return;
+        }
+        destroy_subtree(tree_node->left);
+        destroy_subtree(tree_node->right);
+        delete tree_node;
+    }
+
+    void begin_write() {
+        pthread_mutex_lock(&_writer_mutex);
+        ++_version;
+    }
+
+    /**
+     * @brief Publishes root, advances the epoch past the nodes this write
+     * retired, and frees retired nodes when enough have piled up.
+     */
+    void end_write(CNode* root) {
+        __atomic_store_n(&_root, root, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&_epoch, _epoch + 1, __ATOMIC_SEQ_CST);
+        if (_retired.size() >= _reclaim_at) {
+            reclaim();
+        }
+        pthread_mutex_unlock(&_writer_mutex);
+    }
+
+    /**
+     * @brief Frees the retired nodes no reader can reach: those retired
+     * before the oldest epoch an active reader announced. A reader that
+     * announces an epoch after a node's retirement loads the root after the
+     * node was unlinked.
+     */
+    void reclaim() {
+        unsigned long oldest = _epoch;
+        for (int i = 0; i < MAX_READERS; ++i) {
+            unsigned long announced =
+                __atomic_load_n(&_readers[i].epoch, __ATOMIC_SEQ_CST);
+            if (announced != 0 && announced < oldest) {
+                oldest = announced;
+            }
+        }
+        int freed = 0;
+        while (freed < _retired.size() && _retired[freed].epoch < oldest) {
+            delete _retired[freed].node;
+            ++freed;
+        }
+        int kept = _retired.size() - freed;
+        for (int i = 0; i < kept; ++i) {
+            _retired[i] = _retired[freed + i];
+        }
+        _retired.resize(kept);
+        // A stalled reader can keep nodes alive; back off so the scans stay
+        // amortized O(1) per retired node.
+        _reclaim_at = (2 * kept > RECLAIM_BATCH) ? 2 * kept : RECLAIM_BATCH;
+    }
+
+  public:
+    // Constructor
+    ConcurrentTreap()
+        : _root(0), _epoch(1), _readers(0), _version(0), _priorities(),
+          _retired(), _reclaim_at(RECLAIM_BATCH) {
+        assert(sizeof(ReaderSlot) == CACHE_LINE);
+        std::size_t address = reinterpret_cast<std::size_t>(_reader_storage);
+        address = (address + CACHE_LINE - 1) & ~std::size_t(CACHE_LINE - 1);
+        _readers = reinterpret_cast<ReaderSlot*>(address);
+        for (int i = 0; i < MAX_READERS; ++i) {
+            _readers[i].epoch = 0;
+            _readers[i].in_use = 0;
+        }
+        pthread_mutex_init(&_writer_mutex, 0);
+    }
+
+    // Destructor: no reader may be reading.
+    ~ConcurrentTreap() {
+        destroy_subtree(_root);
+        for (int i = 0; i < _retired.size(); ++i) {
+            delete _retired[i].node;
+        }
+        pthread_mutex_destroy(&_writer_mutex);
+    }
+
+    /**
+     * @brief Inserts a key-value pair if the key is not present. Expected
+     * O(log n).
+     *
+     * @return true if inserted, false if the key was already present.
+     */
+    bool insert(const K& key, const V& value) {
+        begin_write();
+        CNode* root = _root;
+        if (find_node(root, key) != 0) {
+            pthread_mutex_unlock(&_writer_mutex);
+            return false;
+        }
+        CNode* fresh = new CNode(key, value, _priorities.next(), _version);
+        end_write(insert_node(root, fresh));
+        return true;
+    }
+
+    /**
+     * @brief Removes the entry with the given key. Expected O(log n).
+     *
+     * @return true if the key was present.
+     */
+    bool erase(const K& key) {
+        begin_write();
+        CNode* root = _root;
+        if (find_node(root, key) == 0) {
+            pthread_mutex_unlock(&_writer_mutex);
+            return false;
+        }
+        end_write(erase_node(root, key));
+        return true;
+    }
+
+    /**
+     * @brief Replaces the value of an existing key. Expected O(log n).
+     *
+     * @return true if the key was present.
+     */
+    bool set_value(const K& key, const V& value) {
+        begin_write();
+        CNode* root = _root;
+        if (find_node(root, key) == 0) {
+            pthread_mutex_unlock(&_writer_mutex);
+            return false;
+        }
+        end_write(set_value_node(root, key, value));
+        return true;
+    }
+
+    // Removes all entries; the nodes are freed once no reader can see them.
+    void clear() {
+        begin_write();
+        retire_subtree(_root);
+        end_write(0);
+    }
+
+    // Number of entries (a snapshot, may change right after).
+    int size() const {
+        ConcurrentTreap* self = const_cast<ConcurrentTreap*>(this);
+        pthread_mutex_lock(&self->_writer_mutex);
+        int result = get_subtree_size(_root);
+        pthread_mutex_unlock(&self->_writer_mutex);
+        return result;
+    }
+
+    // Number of replaced nodes not freed yet.
+    int retired_count() const {
+        ConcurrentTreap* self = const_cast<ConcurrentTreap*>(this);
+        pthread_mutex_lock(&self->_writer_mutex);
+        int result = _retired.size();
+        pthread_mutex_unlock(&self->_writer_mutex);
+        return result;
+    }
+};
+
+/**
+ * ConcurrentTreapReader
+ * A reader thread's handle on a ConcurrentTreap: it owns one of the tree's
+ * reader slots. Each call reads one consistent snapshot of the tree without
+ * locking and copies the result out, since the nodes may be freed right
+ * after. A reader must be used by one thread at a time.
+ */
+template <typename K, typename V> class ConcurrentTreapReader {
+  private:
+    typedef ConcurrentTreapNode<K, V> CNode;
+    typedef typename ConcurrentTreap<K, V>::ReaderSlot ReaderSlot;
+
+    const ConcurrentTreap<K, V>& _tree;
+    ReaderSlot* _slot;
+
+    // Not copyable: owns the slot.
+    ConcurrentTreapReader(const ConcurrentTreapReader&);
+    ConcurrentTreapReader& operator=(const ConcurrentTreapReader&);
+
+    // Announces the current epoch, then loads the root it protects.
+    CNode* enter() {
+        unsigned long epoch = __atomic_load_n(&_tree._epoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&_slot->epoch, epoch, __ATOMIC_SEQ_CST);
+        return _tree.load_root();
+    }
+
+    void leave() {
+        __atomic_store_n(&_slot->epoch, 0ul, __ATOMIC_RELEASE);
+    }
+
+    // First node not before key (key <= node, or key < node when strict).
+    static CNode* bound(CNode* tree_node, const K& key, bool strict) {
+        CNode* best_node = 0;
+        while (tree_node != 0) {
+            bool before = strict ? !(key < tree_node->key)
+                                 : tree_node->key < key;
+            if (before) {
+                tree_node = tree_node->right;
+            } else {
+                best_node = tree_node;
+                tree_node = tree_node->left;
+            }
+        }
+        return best_node;
+    }
+
+    bool bound_entry(const K& key, bool strict, K& found_key, V& value) {
+        CNode* found = bound(enter(), key, strict);
+        if (found != 0) {
+            found_key = found->key;
+            value = found->value;
+        }
+        leave();
+        return found != 0;
+    }
+
+  public:
+    /**
+     * @brief Registers a reader on tree, claiming a free reader slot (at
+     * most ConcurrentTreap::MAX_READERS at a time).
+     */
+    explicit ConcurrentTreapReader(const ConcurrentTreap<K, V>& tree)
+        : _tree(tree), _slot(0) {
+        ConcurrentTreap<K, V>& slots = const_cast<ConcurrentTreap<K, V>&>(tree);
+        for (int i = 0; i < ConcurrentTreap<K, V>::MAX_READERS; ++i) {
+            int expected = 0;
+            if (__atomic_compare_exchange_n(&slots._readers[i].in_use,
+                                            &expected, 1, false,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED)) {
+                _slot = &slots._readers[i];
+                break;
+            }
+        }
+        assert(_slot != 0); // More than MAX_READERS readers.
+    }
+
+    // Destructor: frees the slot.
+    ~ConcurrentTreapReader() {
+        __atomic_store_n(&_slot->in_use, 0, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief Looks a key up. Expected O(log n).
+     *
+     * @param value Receives the value if found.
+     *
+     * @return true if the key is present.
+     */
+    bool find(const K& key, V& value) {
+        CNode* found = enter();
+        while (found != 0 && (key < found->key || found->key < key)) {
+            found = (key < found->key) ? found->left : found->right;
+        }
+        if (found != 0) {
+            value = found->value;
+        }
+        leave();
+        return found != 0;
+    }
+
+    /**
+     * @brief The first entry with key >= key. Expected O(log n).
+     *
+     * @return true if one exists (found_key and value receive it).
+     */
+    bool lower_bound(const K& key, K& found_key, V& value) {
+        return bound_entry(key, false, found_key, value);
+    }
+
+    /**
+     * @brief The first entry with key > key. Expected O(log n).
+     *
+     * @return true if one exists (found_key and value receive it).
+     */
+    bool upper_bound(const K& key, K& found_key, V& value) {
+        return bound_entry(key, true, found_key, value);
+    }
+
+    // Number of entries in the current snapshot.
+    int size() {
+        CNode* root = enter();
+        int result = (root == 0) ? 0 : root->subtree_size;
+        leave();
+        return result;
+    }
+};
+
+#endif // CONCURRENT_TREAP_H
@@ -0,0 +1,231 @@
+#ifndef EYTZINGER_INDEX_H
+#define EYTZINGER_INDEX_H
+
+// Static, read-only ordered index in Eytzinger (BFS) layout.
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+/**
+ * EytzingerIndex
+ * An immutable snapshot of an ordered map (e.g. Treap::freeze()) laid out for
+ * fast searching:
+ *  - the keys are stored in Eytzinger order, i.e. as an implicit complete
+ *    binary search tree in BFS order (children of slot i at 2i and 2i + 1),
+ *    so the first levels of every search share a few cache lines,
+ *  - the search is branchless (the next slot is computed from the
+ *    comparison, no unpredictable branch) and prefetches the cache line
+ *    holding the current slot's descendants a few levels further down (four
+ *    levels for 4-byte keys),
+ *  - keys and values are also kept in sorted order, so entries are addressed
+ *    by rank: kth(k) is O(1) and rank(key) is a single search.
+ *
+ * Entries are referred to by their 0-based rank; -1 means "no entry", where
+ * Treap would return NULL.
+ */
+template <typename K, typename V> class EytzingerIndex {
+  private:
+    DynamicallySizedArray<K> _keys;       // Sorted.
+    DynamicallySizedArray<V> _values;     // Sorted by key.
+    DynamicallySizedArray<K> _eytzinger;  // Slot 0 unused; slots 1..n.
+    DynamicallySizedArray<int> _rank_of;  // Rank of the key in each slot.
+
+    // Slots per 64-byte cache line. The descendants of slot i that are
+    // log2(PREFETCH_STRIDE) levels down start at slot PREFETCH_STRIDE * i and
+    // fill one line, which is what the search prefetches.
+    static const int PREFETCH_STRIDE =
+        (sizeof(K) >= 64) ? 1 : static_cast<int>(64 / sizeof(K));
+
+    static void prefetch(const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    /**
+     * @brief Fills the Eytzinger slots of the subtree rooted at slot with the
+     * next sorted keys (an in-order walk of the implicit tree).
+     *
+     * @param slot The subtree root slot.
+     * @param next_rank The next sorted rank to place; advanced.
+     */
+    void fill(int slot, int& next_rank) {
+        int n = _keys.size();
+        if (slot > n) {
+            return;
+        }
+        fill(2 * slot, next_rank);
+        _eytzinger[slot] = _keys[next_rank];
+        _rank_of[slot] = next_rank++;
+        fill(2 * slot + 1, next_rank);
+    }
+
+    /**
+     * @brief Branchless descent over the Eytzinger slots.
+     *
+     * At every slot the search goes right while the slot is before the
+     * target (key < target, or key <= target when strict). The answer is the
+     * last slot where it went left: undo the trailing right turns (the
+     * trailing one bits of the final slot) and one left turn.
+     *
+     * @return The rank of the first key not before the target, or -1.
+     */
+    int search(const K& key, bool strict) const {
+        int n = _keys.size();
+        if (n == 0) {
+            return -1;
+        }
+        const K* slots = &_eytzinger[0];
+        // Prefetch only slots that exist: a pointer past the array is
+        // undefined even if the prefetch itself cannot fault.
+        const unsigned int last = static_cast<unsigned int>(n);
+        unsigned int slot = 1;
+        if (strict) {
+            while (slot <= last) {
+                if (PREFETCH_STRIDE * slot <= last) {
+                    prefetch(slots + PREFETCH_STRIDE * slot);
+                }
+                slot = 2 * slot + !(key < slots[slot]);
+            }
+        } else {
+            while (slot <= last) {
+                if (PREFETCH_STRIDE * slot <= last) {
+                    prefetch(slots + PREFETCH_STRIDE * slot);
+                }
+                slot = 2 * slot + (slots[slot] < key);
+            }
+        }
+#if defined(__GNUC__)
+        slot >>= __builtin_ffs(~slot);
+#else
+        while (slot & 1u) {
+            slot >>= 1;
+        }
+        slot >>= 1;
+#endif
+        return (slot == 0) ? -1 : _rank_of[slot];
+    }
+
+  public:
+    // Constructor: an empty index.
+    EytzingerIndex() : _keys(), _values(), _eytzinger(), _rank_of() {}
+
+    /**
+     * @brief Builds the index from n entries in strictly increasing key
+     * order. O(n).
+     */
+    EytzingerIndex(const K* keys, const V* values, int n)
+        : _keys(), _values(), _eytzinger(), _rank_of() {
+        assign(keys, values, n);
+    }
+
+    // Copy Constructor
+    EytzingerIndex(const EytzingerIndex& other)
+        : _keys(other._keys), _values(other._values),
+          _eytzinger(other._eytzinger), _rank_of(other._rank_of) {}
+
+    // Assignment operator
+    EytzingerIndex& operator=(const EytzingerIndex& other) {
+        if (this != &other) {
+            _keys = other._keys;
+            _values = other._values;
+            _eytzinger = other._eytzinger;
+            _rank_of = other._rank_of;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~EytzingerIndex() {}
+
+    /**
+     * @brief Replaces the contents with n entries in strictly increasing key
+     * order. O(n).
+     *
+     * @param keys Keys in strictly increasing order.
+     * @param values Values matching keys.
+     * @param n Number of entries (>= 0).
+     */
+    void assign(const K* keys, const V* values, int n) {
+        assert(n >= 0);
+        _keys.resize(n);
+        _values.resize(n);
+        for (int i = 0; i < n; ++i) {
+            assert(i == 0 || keys[i - 1] < keys[i]);
+            _keys[i] = keys[i];
+            _values[i] = values[i];
+        }
+        _eytzinger.resize(n + 1);
+        _rank_of.resize(n + 1);
+        int next_rank = 0;
+        fill(1, next_rank);
+    }
+
+    /**
+     * @brief Finds the entry with the given key. O(log n).
+     *
+     * @return Its rank, or -1 if the key is not present.
+     */
+    int find(const K& key) const {
+        int found = search(key, false);
+        if (found >= 0 && !(key < _keys[found])) {
+            return found;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Finds the first entry with key >= key. O(log n).
+     *
+     * @return Its rank, or -1 if none exists.
+     */
+    int lower_bound(const K& key) const {
+        return search(key, false);
+    }
+
+    /**
+     * @brief Finds the first entry with key > key. O(log n).
+     *
+     * @return Its rank, or -1 if none exists.
+     */
+    int upper_bound(const K& key) const {
+        return search(key, true);
+    }
+
+    /**
+     * @brief The k-th smallest entry (0-based). O(1).
+     *
+     * @return k, or -1 if k is out of range.
+     */
+    int kth(int k) const {
+        return (k < 0 || k >= _keys.size()) ? -1 : k;
+    }
+
+    /**
+     * @brief The rank of the entry with the given key (the number of
+     * smaller keys). O(log n).
+     *
+     * @return The rank, or -1 if the key is not present.
+     */
+    int rank(const K& key) const {
+        return find(key);
+    }
+
+    // Key of the entry with the given rank.
+    const K& key(int rank) const {
+        return _keys[rank];
+    }
+
+    // Value of the entry with the given rank.
+    const V& value(int rank) const {
+        return _values[rank];
+    }
+
+    // Number of entries.
+    int size() const {
+        return _keys.size();
+    }
+};
+
+#endif // EYTZINGER_INDEX_H
@@ -0,0 +1,464 @@
+#ifndef FLAT_ORDERED_MAP_H
+#define FLAT_ORDERED_MAP_H
+
+// Sorted-array ordered map with a small insert buffer and the Treap API.
+#include "DynamicallySizedArray.h"
+#include <cassert>
+
+// The insert buffer never holds fewer than this many entries before a merge.
+static const int FLAT_MIN_BUFFER = 32;
+
+/**
+ * FlatOrderedMapCursor
+ * A position in a FlatOrderedMap: main_index / buffer_index count the
+ * entries of the main array / the buffer that come before it, and in_buffer
+ * says which of the two arrays holds it (at that index). The unset cursor
+ * has main_index -1. Entries move on every change, so a cursor is valid
+ * until the next insert, insert_batch or erase on its map.
+ */
+struct FlatOrderedMapCursor {
+    int main_index;
+    int buffer_index;
+    bool in_buffer;
+
+    FlatOrderedMapCursor()
+        : main_index(-1), buffer_index(0), in_buffer(false) {}
+    FlatOrderedMapCursor(int m, int b, bool buffer)
+        : main_index(m), buffer_index(b), in_buffer(buffer) {}
+
+    // Whether the cursor points at an entry.
+    bool is_set() const {
+        return main_index >= 0;
+    }
+};
+
+/**
+ * FlatOrderedMap
+ * An ordered map with the Treap<K,V> operation set on sorted arrays, for
+ * read-heavy workloads:
+ *
+ *  - the main array holds most entries, keys and values in separate
+ *    DynamicallySizedArrays so a search only touches keys,
+ *  - new keys go into a small sorted buffer (shifting O(buffer) entries);
+ *    once it outgrows ~sqrt(size) it is merged into the main array in one
+ *    backward pass, so an insert costs O(sqrt n) amortized,
+ *  - lookups run a branchless binary search on both arrays and take the
+ *    smaller hit, O(log n),
+ *  - the position of an entry is its index in one array plus its count in
+ *    the other, so rank, successor and predecessor are O(1) and kth is a
+ *    binary search for the split between the two arrays, O(log n),
+ *  - erase shifts the rest of its array down, O(n).
+ *
+ * insert_batch sorts its keys and merges them straight into the main array.
+ * Cursors are FlatOrderedMapCursor positions instead of node pointers; read
+ * the entry through key(cursor) / value(cursor).
+ */
+template <typename K, typename V> class FlatOrderedMap {
+  public:
+    typedef FlatOrderedMapCursor cursor;
+
+  private:
+    DynamicallySizedArray<K> _keys;   // Main array, sorted.
+    DynamicallySizedArray<V> _values; // Values of _keys.
+    DynamicallySizedArray<K> _buffer_keys;   // Insert buffer, sorted.
+    DynamicallySizedArray<V> _buffer_values; // Values of _buffer_keys.
+    int _buffer_limit; // Merge once the buffer holds more than this.
+
+    /**
+     * @brief Number of keys in sorted[0, n) that are < key (strict false) or
+     * <= key (strict true). The loop body compiles to a conditional move.
+     */
+    static int count_before(const DynamicallySizedArray<K>& sorted,
+                            const K& key, bool strict) {
+        int n = sorted.size();
+        if (n == 0) {
+            return 0;
+        }
+        const K* first = &sorted[0];
+        const K* base = first;
+        if (strict) {
+            while (n > 1) {
+                int half = n / 2;
+                base = (key < base[half]) ? base : base + half;
+                n -= half;
+            }
+            return static_cast<int>(base - first) + !(key < *base);
+        }
+        while (n > 1) {
+            int half = n / 2;
+            base = (base[half] < key) ? base + half : base;
+            n -= half;
+        }
+        return static_cast<int>(base - first) + (*base < key);
+    }
+
+    /**
+     * @brief The entry at the given counts: the smaller of the next main
+     * entry and the next buffer entry.
+     *
+     * @param main_index Number of main entries before the position.
+     * @param buffer_index Number of buffer entries before the position.
+     *
+     * @return The cursor, or the unset cursor if both arrays are exhausted.
+     */
+    cursor next_at(int main_index, int buffer_index) const {
+        bool main_left = main_index < _keys.size();
+        bool buffer_left = buffer_index < _buffer_keys.size();
+        if (main_left &&
+            (!buffer_left || _keys[main_index] < _buffer_keys[buffer_index])) {
+            return cursor(main_index, buffer_index, false);
+        }
+        if (buffer_left) {
+            return cursor(main_index, buffer_index, true);
+        }
+        return cursor();
+    }
+
+    /**
+     * @brief The entry just before the given counts: the larger of the last
+     * main entry and the last buffer entry before the position.
+     *
+     * @return The cursor, or the unset cursor if nothing comes before.
+     */
+    cursor previous_at(int main_index, int buffer_index) const {
+        if (main_index > 0 &&
+            (buffer_index == 0 ||
+             _buffer_keys[buffer_index - 1] < _keys[main_index - 1])) {
+            return cursor(main_index - 1, buffer_index, false);
+        }
+        if (buffer_index > 0) {
+            return cursor(main_index, buffer_index - 1, true);
+        }
+        return cursor();
+    }
+
+    // Recomputes the buffer limit as about sqrt of the main array size.
+    void update_buffer_limit() {
+        int limit = FLAT_MIN_BUFFER;
+        while (limit * limit < _keys.size()) {
+            limit *= 2;
+        }
+        _buffer_limit = limit;
+    }
+
+    /**
+     * @brief Merges sorted extra entries (none of them present) into the main
+     * array, writing from the back so no scratch copy of it is needed.
+     * O(size + count).
+     */
+    void merge_into_main(const DynamicallySizedArray<K>& extra_keys,
+                         const DynamicallySizedArray<V>& extra_values,
+                         int count) {
+        int i = _keys.size() - 1;
+        int j = count - 1;
+        int out = _keys.size() + count;
+        _keys.resize(out);
+        _values.resize(out);
+        while (j >= 0) {
+            --out;
+            if (i >= 0 && extra_keys[j] < _keys[i]) {
+                _keys[out] = _keys[i];
+                _values[out] = _values[i];
+                --i;
+            } else {
+                _keys[out] = extra_keys[j];
+                _values[out] = extra_values[j];
+                --j;
+            }
+        }
+        update_buffer_limit();
+    }
+
+    // Moves the buffer into the main array.
+    void flush() {
+        if (_buffer_keys.size() == 0) {
+            return;
+        }
+        merge_into_main(_buffer_keys, _buffer_values, _buffer_keys.size());
+        _buffer_keys.clear();
+        _buffer_values.clear();
+    }
+
+    /**
+     * @brief Stable bottom-up merge sort of the positions 0..n-1 by
+     * keys[position], so equal keys keep their input order.
+     */
+    static void sort_positions(const K* keys, int n,
+                               DynamicallySizedArray<int>& order) {
+        DynamicallySizedArray<int> scratch;
+        order.resize(n);
+        scratch.resize(n);
+        for (int i = 0; i < n; ++i) {
+            order[i] = i;
+        }
+        for (int width = 1; width < n; width *= 2) {
+            for (int lo = 0; lo < n; lo += 2 * width) {
+                int mid = (lo + width < n) ? lo + width : n;
+                int hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+                int a = lo;
+                int b = mid;
+                for (int out = lo; out < hi; ++out) {
+                    if (a < mid &&
+                        (b >= hi || !(keys[order[b]] < keys[order[a]]))) {
+                        scratch[out] = order[a++];
+                    } else {
+                        scratch[out] = order[b++];
+                    }
+                }
+            }
+            for (int i = 0; i < n; ++i) {
+                order[i] = scratch[i];
+            }
+        }
+    }
+
+  public:
+    // Constructor: an empty map.
+    FlatOrderedMap()
+        : _keys(), _values(), _buffer_keys(), _buffer_values(),
+          _buffer_limit(FLAT_MIN_BUFFER) {}
+
+    // Copy Constructor
+    FlatOrderedMap(const FlatOrderedMap& other)
+        : _keys(other._keys), _values(other._values),
+          _buffer_keys(other._buffer_keys),
+          _buffer_values(other._buffer_values),
+          _buffer_limit(other._buffer_limit) {}
+
+    // Assignment operator
+    FlatOrderedMap& operator=(const FlatOrderedMap& other) {
+        if (this != &other) {
+            _keys = other._keys;
+            _values = other._values;
+            _buffer_keys = other._buffer_keys;
+            _buffer_values = other._buffer_values;
+            _buffer_limit = other._buffer_limit;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~FlatOrderedMap() {}
+
+    // Number of entries.
+    int size() const {
+        return _keys.size() + _buffer_keys.size();
+    }
+
+    // Removes every entry.
+    void clear() {
+        _keys = DynamicallySizedArray<K>();
+        _values = DynamicallySizedArray<V>();
+        _buffer_keys = DynamicallySizedArray<K>();
+        _buffer_values = DynamicallySizedArray<V>();
+        _buffer_limit = FLAT_MIN_BUFFER;
+    }
+
+    // Key of the entry at position (which must be set).
+    const K& key(const cursor& position) const {
+        assert(position.is_set());
+        return position.in_buffer ? _buffer_keys[position.buffer_index]
+                                  : _keys[position.main_index];
+    }
+
+    // Value of the entry at position (which must be set); may be assigned.
+    V& value(const cursor& position) {
+        assert(position.is_set());
+        return position.in_buffer ? _buffer_values[position.buffer_index]
+                                  : _values[position.main_index];
+    }
+
+    const V& value(const cursor& position) const {
+        assert(position.is_set());
+        return position.in_buffer ? _buffer_values[position.buffer_index]
+                                  : _values[position.main_index];
+    }
+
+    /**
+     * @brief Finds the entry with the given key. O(log n).
+     *
+     * @return Its cursor, or the unset cursor if the key is absent.
+     */
+    cursor find(const K& key_to_find) const {
+        cursor found = lower_bound(key_to_find);
+        if (found.is_set() && key_to_find < key(found)) {
+            return cursor();
+        }
+        return found;
+    }
+
+    /**
+     * @brief The first entry whose key is >= key. O(log n).
+     *
+     * @return Its cursor, or the unset cursor if there is none.
+     */
+    cursor lower_bound(const K& key_to_find) const {
+        return next_at(count_before(_keys, key_to_find, false),
+                       count_before(_buffer_keys, key_to_find, false));
+    }
+
+    /**
+     * @brief The first entry whose key is > key. O(log n).
+     *
+     * @return Its cursor, or the unset cursor if there is none.
+     */
+    cursor upper_bound(const K& key_to_find) const {
+        return next_at(count_before(_keys, key_to_find, true),
+                       count_before(_buffer_keys, key_to_find, true));
+    }
+
+    /**
+     * @brief Inserts key with value unless key is present. O(sqrt n)
+     * amortized: the buffer insert shifts O(sqrt n) entries and every
+     * ~sqrt n inserts pay an O(n) merge.
+     *
+     * @return The cursor of the new entry, or of the existing entry with the
+     * same key (whose value is left unchanged).
+     */
+    cursor insert(const K& new_key, const V& new_value) {
+        int main_index = count_before(_keys, new_key, false);
+        int buffer_index = count_before(_buffer_keys, new_key, false);
+        cursor found = next_at(main_index, buffer_index);
+        if (found.is_set() && !(new_key < key(found))) {
+            return found;
+        }
+        _buffer_keys.insert(buffer_index, new_key);
+        _buffer_values.insert(buffer_index, new_value);
+        if (_buffer_keys.size() > _buffer_limit) {
+            flush();
+            return cursor(main_index + buffer_index, 0, false);
+        }
+        return cursor(main_index, buffer_index, true);
+    }
+
+    /**
+     * @brief Inserts n key-value pairs, as n insert() calls in input order
+     * would (the first of equal keys wins, present keys are left unchanged),
+     * with one sort of the batch and one merge. O(n log n + size).
+     *
+     * @return The number of entries added.
+     */
+    int insert_batch(const K* keys, const V* values, int n) {
+        flush();
+        DynamicallySizedArray<int> order;
+        sort_positions(keys, n, order);
+
+        DynamicallySizedArray<K> added_keys;
+        DynamicallySizedArray<V> added_values;
+        added_keys.reserve(n);
+        added_values.reserve(n);
+        int main_index = 0;
+        for (int i = 0; i < n; ++i) {
+            const K& candidate = keys[order[i]];
+            if (i > 0 && !(keys[order[i - 1]] < candidate)) {
+                continue; // Equal to the previous batch key.
+            }
+            while (main_index < _keys.size() &&
+                   _keys[main_index] < candidate) {
+                ++main_index;
+            }
+            if (main_index < _keys.size() &&
+                !(candidate < _keys[main_index])) {
+                continue; // Already present.
+            }
+            added_keys.push_back(candidate);
+            added_values.push_back(values[order[i]]);
+        }
+        merge_into_main(added_keys, added_values, added_keys.size());
+        return added_keys.size();
+    }
+
+    /**
+     * @brief Removes the entry at position (no-op if unset). O(n).
+     */
+    void erase(const cursor& position) {
+        if (!position.is_set()) {
+            return;
+        }
+        if (position.in_buffer) {
+            _buffer_keys.erase(position.buffer_index);
+            _buffer_values.erase(position.buffer_index);
+        } else {
+            _keys.erase(position.main_index);
+            _values.erase(position.main_index);
+        }
+    }
+
+    // The entry with the smallest key, or the unset cursor. O(1).
+    cursor front() const {
+        return next_at(0, 0);
+    }
+
+    // The entry with the largest key, or the unset cursor. O(1).
+    cursor back() const {
+        return previous_at(_keys.size(), _buffer_keys.size());
+    }
+
+    // The next entry in key order, or the unset cursor. O(1).
+    cursor successor(const cursor& position) const {
+        if (!position.is_set()) {
+            return cursor();
+        }
+        if (position.in_buffer) {
+            return next_at(position.main_index, position.buffer_index + 1);
+        }
+        return next_at(position.main_index + 1, position.buffer_index);
+    }
+
+    // The previous entry in key order, or the unset cursor. O(1).
+    cursor predecessor(const cursor& position) const {
+        if (!position.is_set()) {
+            return cursor();
+        }
+        return previous_at(position.main_index, position.buffer_index);
+    }
+
+    /**
+     * @brief Number of entries with keys less than the entry's key. O(1).
+     *
+     * @return The rank, or -1 if position is unset.
+     */
+    int rank(const cursor& position) const {
+        if (!position.is_set()) {
+            return -1;
+        }
+        return position.main_index + position.buffer_index;
+    }
+
+    /**
+     * @brief The entry with the k-th smallest key (0-based). Binary searches
+     * how many of the first k + 1 entries come from the buffer. O(log n).
+     *
+     * @return Its cursor, or the unset cursor if k is out of range.
+     */
+    cursor kth(int k) const {
+        int main_size = _keys.size();
+        int buffer_size = _buffer_keys.size();
+        if (k < 0 || k >= main_size + buffer_size) {
+            return cursor();
+        }
+        int taken = k + 1;
+        int lo = (taken > main_size) ? taken - main_size : 0;
+        int hi = (taken < buffer_size) ? taken : buffer_size;
+        for (;;) {
+            int from_buffer = lo + (hi - lo) / 2;
+            int from_main = taken - from_buffer;
+            if (from_buffer > 0 && from_main < main_size &&
+                _keys[from_main] < _buffer_keys[from_buffer - 1]) {
+                hi = from_buffer - 1; // Took a buffer key past a main key.
+            } else if (from_main > 0 && from_buffer < buffer_size &&
+                       _buffer_keys[from_buffer] < _keys[from_main - 1]) {
+                lo = from_buffer + 1; // Took a main key past a buffer key.
+            } else {
+                return previous_at(from_main, from_buffer);
+            }
+        }
+    }
+
+    // Alias, just in case.
+    cursor kth_element(int k) const {
+        return kth(k);
+    }
+};
+
+#endif // FLAT_ORDERED_MAP_H
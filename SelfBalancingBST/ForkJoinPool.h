@@ -0,0 +1,176 @@
+#ifndef FORK_JOIN_POOL_H
+#define FORK_JOIN_POOL_H
+
+// Small fork-join task pool on POSIX threads (link with -pthread).
+#include <cassert>
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * ForkJoinTask
+ * A unit of work for ForkJoinPool: derive from it, store the inputs and
+ * outputs as members and implement run(). A task lives on the forking
+ * thread's stack and is forked and joined at most once.
+ */
+class ForkJoinTask {
+  public:
+    ForkJoinTask() : _state(0) {}
+    virtual ~ForkJoinTask() {}
+    virtual void run() = 0;
+
+  private:
+    friend class ForkJoinPool;
+    int _state; // ForkJoinPool::TaskState, guarded by the pool's mutex.
+};
+
+/**
+ * ForkJoinPool
+ * Runs forked tasks on thread_count() - 1 worker threads; the forking
+ * thread is the remaining one.
+ *
+ *  - fork(task) pushes the task on a shared LIFO stack (or runs it right
+ *    away if the stack is full),
+ *  - join(task) runs the task inline if no worker has taken it yet;
+ *    otherwise the joining thread runs other queued tasks until it is done,
+ *    so threads blocked in join never leave work idle.
+ *
+ * Forks must be strictly nested (join in reverse fork order per thread), as
+ * in recursive divide and conquer.
+ */
+class ForkJoinPool {
+  private:
+    enum TaskState { TASK_IDLE, TASK_QUEUED, TASK_RUNNING, TASK_DONE };
+    static const int QUEUE_CAPACITY = 1024;
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _changed; // A task was queued or finished, or stopping.
+    ForkJoinTask* _queue[QUEUE_CAPACITY]; // LIFO stack.
+    int _queued;
+    pthread_t* _workers;
+    int _worker_count;
+    bool _stopping;
+
+    // Runs task; called and returns with the mutex held.
+    void run_locked(ForkJoinTask* task) {
+        task->_state = TASK_RUNNING;
+        pthread_mutex_unlock(&_mutex);
+        task->run();
+        pthread_mutex_lock(&_mutex);
+        task->_state = TASK_DONE;
+        pthread_cond_broadcast(&_changed);
+    }
+
+    static void* worker_main(void* argument) {
+        ForkJoinPool* pool = static_cast<ForkJoinPool*>(argument);
+        pthread_mutex_lock(&pool->_mutex);
+        for (;;) {
+            while (pool->_queued == 0 && !pool->_stopping) {
+                pthread_cond_wait(&pool->_changed, &pool->_mutex);
+            }
+            if (pool->_queued == 0) {
+                break; // Stopping, and nothing left to run.
+            }
+            pool->run_locked(pool->_queue[--pool->_queued]);
+        }
+        pthread_mutex_unlock(&pool->_mutex);
+        return 0;
+    }
+
+    // Not copyable.
+    ForkJoinPool(const ForkJoinPool&);
+    ForkJoinPool& operator=(const ForkJoinPool&);
+
+  public:
+    typedef ForkJoinTask task_type;
+
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads Total threads including the caller; 0 uses one per
+     * online CPU. 1 runs every task on the forking thread.
+     */
+    explicit ForkJoinPool(int threads = 0)
+        : _queued(0), _workers(0), _worker_count(0), _stopping(false) {
+        if (threads <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = (cpus > 0) ? static_cast<int>(cpus) : 1;
+        }
+        pthread_mutex_init(&_mutex, 0);
+        pthread_cond_init(&_changed, 0);
+        if (threads > 1) {
+            _workers = new pthread_t[threads - 1];
+        }
+        for (int i = 0; i + 1 < threads; ++i) {
+            if (pthread_create(&_workers[i], 0, worker_main, this) != 0) {
+                break; // Run with the workers that did start.
+            }
+            ++_worker_count;
+        }
+    }
+
+    // Destructor: runs what is still queued, then stops the workers.
+    ~ForkJoinPool() {
+        pthread_mutex_lock(&_mutex);
+        _stopping = true;
+        pthread_cond_broadcast(&_changed);
+        pthread_mutex_unlock(&_mutex);
+        for (int i = 0; i < _worker_count; ++i) {
+            pthread_join(_workers[i], 0);
+        }
+        delete[] _workers;
+        pthread_cond_destroy(&_changed);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    // Number of threads that run tasks, including the forking thread.
+    int thread_count() const {
+        return _worker_count + 1;
+    }
+
+    /**
+     * @brief Makes task available to the workers. Runs it right away when
+     * there are no workers or the queue is full.
+     */
+    void fork(ForkJoinTask& task) {
+        pthread_mutex_lock(&_mutex);
+        assert(task._state == TASK_IDLE);
+        if (_worker_count == 0 || _queued == QUEUE_CAPACITY) {
+            run_locked(&task);
+        } else {
+            task._state = TASK_QUEUED;
+            _queue[_queued++] = &task;
+            pthread_cond_broadcast(&_changed);
+        }
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    /**
+     * @brief Waits until a forked task has run, running it (or other queued
+     * tasks) on this thread meanwhile.
+     */
+    void join(ForkJoinTask& task) {
+        pthread_mutex_lock(&_mutex);
+        if (task._state == TASK_QUEUED) {
+            // Not taken yet: it is usually on top of the stack.
+            int slot = _queued - 1;
+            while (_queue[slot] != &task) {
+                --slot;
+            }
+            for (int i = slot + 1; i < _queued; ++i) {
+                _queue[i - 1] = _queue[i];
+            }
+            --_queued;
+            run_locked(&task);
+        }
+        while (task._state != TASK_DONE) {
+            if (_queued > 0) {
+                run_locked(_queue[--_queued]);
+            } else {
+                pthread_cond_wait(&_changed, &_mutex);
+            }
+        }
+        pthread_mutex_unlock(&_mutex);
+    }
+};
+
+#endif // FORK_JOIN_POOL_H
@@ -0,0 +1,270 @@
+#ifndef INTERVAL_TREAP_H
+#define INTERVAL_TREAP_H
+
+// Interval map on a Treap keyed by start, augmented with the max end.
+#include "SelfBalancingBST.h"
+#include <cassert>
+
+/**
+ * TreapIntervalKey
+ * The Treap key of an IntervalTreap entry: the interval's start, then its
+ * insertion number, so any number of intervals can share a start. Ordered
+ * by start, ties in insertion order.
+ */
+template <typename K> struct TreapIntervalKey {
+    K start;
+    unsigned long sequence;
+
+    TreapIntervalKey() : start(), sequence(0) {}
+    TreapIntervalKey(const K& s, unsigned long n) : start(s), sequence(n) {}
+
+    bool operator<(const TreapIntervalKey& other) const {
+        if (start < other.start) {
+            return true;
+        }
+        return !(other.start < start) && sequence < other.sequence;
+    }
+};
+
+/**
+ * TreapInterval
+ * The Treap value of an IntervalTreap entry: the interval's end and the
+ * user's value (the start is in the Treap key).
+ */
+template <typename K, typename V> struct TreapInterval {
+    K end;
+    V value;
+
+    TreapInterval() : end(), value() {}
+    TreapInterval(const K& e, const V& v) : end(e), value(v) {}
+};
+
+// Maximum interval end in a subtree (identity: the smallest K).
+template <typename K, typename V> struct TreapMaxEnd {
+    typedef K value_type;
+
+    static K identity() {
+        return TreapMax<K>::identity();
+    }
+    static K lift(TreapInterval<K, V> const& interval) {
+        return interval.end;
+    }
+    static K combine(K const& a, K const& b) {
+        return TreapMax<K>::combine(a, b);
+    }
+};
+
+/**
+ * IntervalTreap
+ * A map from half-open intervals [start, end) to values. It is a
+ * Treap<TreapIntervalKey<K>, TreapInterval<K,V>, TreapMaxEnd<K,V>> keyed by
+ * (start, insertion number), so intervals with equal starts (or equal
+ * starts and ends) are all kept. Every node's aggregate is the largest end
+ * in its subtree, kept up to date by the treap's pull() on inserts, erases
+ * and rotations.
+ *
+ * A query walks the tree in start order and skips every subtree whose
+ * largest end is not past the query's low end, and everything that starts
+ * at or after its high end.
+ */
+template <typename K, typename V> class IntervalTreap {
+  public:
+    typedef TreapIntervalKey<K> key_type;
+    typedef TreapInterval<K, V> interval_type;
+    typedef TreapMaxEnd<K, V> monoid_type;
+    typedef TreapNode<key_type, interval_type, monoid_type> node_type;
+
+  private:
+    Treap<key_type, interval_type, monoid_type> _tree;
+    unsigned long _next_sequence; // Insertion number of the next interval.
+
+    /**
+     * @brief Reports, in start order, the intervals of the subtree with
+     * lo < end and start < hi (start <= hi if inclusive_hi).
+     *
+     * The right spine is walked in a loop, the left subtrees recursively.
+     *
+     * @return The number of intervals reported.
+     */
+    template <typename Callback>
+    static int report(const node_type* node, const K& lo, const K& hi,
+                      bool inclusive_hi, Callback& callback) {
+        int reported = 0;
+        while (node != 0 && lo < node->aggregate) {
+            reported += report(node->left, lo, hi, inclusive_hi, callback);
+            bool starts_in = inclusive_hi ? !(hi < node->key.start)
+                                          : node->key.start < hi;
+            if (!starts_in) {
+                return reported; // So does all of the right subtree.
+            }
+            if (lo < node->value.end) {
+                callback(node->key.start, node->value.end, node->value.value);
+                ++reported;
+            }
+            node = node->right;
+        }
+        return reported;
+    }
+
+    /**
+     * @brief The interval with the largest start in the subtree that
+     * contains point, given that every start in it is <= point and its
+     * largest end is > point. O(depth).
+     */
+    static node_type* last_containing(node_type* node, const K& point) {
+        for (;;) {
+            if (node->right != 0 && point < node->right->aggregate) {
+                node = node->right;
+            } else if (point < node->value.end) {
+                return node;
+            } else {
+                node = node->left;
+            }
+        }
+    }
+
+  public:
+    // Constructor: an empty map.
+    IntervalTreap() : _tree(), _next_sequence(0) {}
+
+    // Copy Constructor
+    IntervalTreap(const IntervalTreap& other)
+        : _tree(other._tree), _next_sequence(other._next_sequence) {}
+
+    // Assignment operator
+    IntervalTreap& operator=(const IntervalTreap& other) {
+        if (this != &other) {
+            _tree = other._tree;
+            _next_sequence = other._next_sequence;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~IntervalTreap() {}
+
+    // Number of intervals.
+    int size() const {
+        return _tree.size();
+    }
+
+    // Removes every interval.
+    void clear() {
+        _tree.clear();
+    }
+
+    /**
+     * @brief Inserts the interval [start, end) with a value, also when
+     * intervals with the same start are already present. Expected O(log n).
+     *
+     * @return The new node.
+     */
+    node_type* insert(const K& start, const K& end, const V& value) {
+        assert(start < end);
+        return _tree.insert(key_type(start, _next_sequence++),
+                            interval_type(end, value));
+    }
+
+    /**
+     * @brief The first-inserted interval starting at start, or NULL; later
+     * ones with the same start come right after it in start order.
+     * Expected O(log n).
+     */
+    node_type* find(const K& start) const {
+        node_type* node = _tree.lower_bound(key_type(start, 0));
+        if (node != 0 && !(start < node->key.start)) {
+            return node;
+        }
+        return 0;
+    }
+
+    // Removes the interval at node (safe on NULL). Expected O(log n).
+    void erase(node_type* node) {
+        _tree.erase(node);
+    }
+
+    /**
+     * @brief Changes an interval's end and value, refreshing the max ends on
+     * its path to the root. Expected O(log n).
+     *
+     * @param node The interval to update (safe on NULL).
+     */
+    void set_interval(node_type* node, const K& end, const V& value) {
+        if (node != 0) {
+            assert(node->key.start < end);
+            _tree.set_value(node, interval_type(end, value));
+        }
+    }
+
+    /**
+     * @brief Calls callback(start, end, value) for every interval that
+     * overlaps [lo, hi) (start < hi and lo < end), in start order.
+     *
+     * The intervals starting in [lo, hi) are one contiguous run of the
+     * tree; each reported interval that starts before lo costs at most one
+     * extra root-to-node path. Expected O(log n + k), plus O(log n) per
+     * reported interval starting before lo.
+     *
+     * @return The number of intervals reported.
+     */
+    template <typename Callback>
+    int overlapping(const K& lo, const K& hi, Callback& callback) const {
+        if (!(lo < hi)) {
+            return 0;
+        }
+        return report(_tree.root(), lo, hi, false, callback);
+    }
+
+    /**
+     * @brief Calls callback(start, end, value) for every interval containing
+     * point (start <= point < end), in start order. Same cost as
+     * overlapping().
+     *
+     * @return The number of intervals reported.
+     */
+    template <typename Callback>
+    int stab(const K& point, Callback& callback) const {
+        return report(_tree.root(), point, point, true, callback);
+    }
+
+    /**
+     * @brief The interval containing point (start <= point < end) with the
+     * largest start, i.e. the innermost of nested intervals (the last
+     * inserted of those with that start).
+     *
+     * Visits the starts <= point in decreasing order from the search path's
+     * last node: each node, then its left subtree, then the next ancestor
+     * to the left via parent links. Only a subtree whose largest end is past
+     * point is entered, and then only to find its answer. Expected
+     * O(log n).
+     *
+     * @return The node, or NULL if no interval contains point.
+     */
+    node_type* stab(const K& point) const {
+        node_type* candidate = 0;
+        for (node_type* node = _tree.root(); node != 0;) {
+            if (point < node->key.start) {
+                node = node->left;
+            } else {
+                candidate = node;
+                node = node->right;
+            }
+        }
+        while (candidate != 0) {
+            if (point < candidate->value.end) {
+                return candidate;
+            }
+            if (candidate->left != 0 && point < candidate->left->aggregate) {
+                return last_containing(candidate->left, point);
+            }
+            while (candidate->parent != 0 &&
+                   candidate == candidate->parent->left) {
+                candidate = candidate->parent;
+            }
+            candidate = candidate->parent;
+        }
+        return 0;
+    }
+};
+
+#endif // INTERVAL_TREAP_H
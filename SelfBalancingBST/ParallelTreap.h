@@ -0,0 +1,65 @@
+#ifndef PARALLEL_TREAP_H
+#define PARALLEL_TREAP_H
+
+// Treap with bulk operations on a ForkJoinPool (link with -pthread).
+#include "ForkJoinPool.h"
+#include "SelfBalancingBST.h"
+
+/**
+ * ParallelTreap
+ * A Treap whose bulk operations also take a ForkJoinPool& pool. They give
+ * the same results as the sequential versions: after a split, the two
+ * halves of a set operation touch disjoint nodes, so the right half is
+ * forked when it is large; build_from_sorted() builds the two halves of
+ * the input in parallel and filter() filters the two subtrees in parallel.
+ * Kept out of SelfBalancingBST.h so the plain Treap needs no threads.
+ */
+template <typename K, typename V, typename Monoid = TreapNoAggregate,
+          typename Index = TreapNoIndex>
+class ParallelTreap : public Treap<K, V, Monoid, Index> {
+  private:
+    typedef Treap<K, V, Monoid, Index> base_type;
+
+  public:
+    using base_type::build_from_sorted;
+    using base_type::set_union;
+    using base_type::set_intersection;
+    using base_type::set_difference;
+    using base_type::filter;
+
+    /**
+     * @brief build_from_sorted() on a task pool: halves of the input are
+     * built in parallel and joined. Gives the same tree as the sequential
+     * version. O(n) work, O(n / threads + log^2 n) span.
+     */
+    void build_from_sorted(const K* keys, const V* values, int n,
+                           ForkJoinPool& pool) {
+        this->build_with(keys, values, n, &pool);
+    }
+
+    // set_union() with the independent halves run in parallel on pool.
+    void set_union(base_type& other, ForkJoinPool& pool) {
+        this->union_with(other, &pool);
+    }
+
+    // set_intersection() with the independent halves run in parallel on pool.
+    void set_intersection(base_type& other, ForkJoinPool& pool) {
+        this->intersection_with(other, &pool);
+    }
+
+    // set_difference() with the independent halves run in parallel on pool.
+    void set_difference(base_type& other, ForkJoinPool& pool) {
+        this->difference_with(other, &pool);
+    }
+
+    /**
+     * @brief filter() with the subtrees filtered in parallel on pool. pred
+     * is called concurrently from the pool's threads.
+     */
+    template <typename Predicate>
+    void filter(Predicate pred, ForkJoinPool& pool) {
+        this->filter_with(pred, &pool);
+    }
+};
+
+#endif // PARALLEL_TREAP_H
@@ -0,0 +1,593 @@
+#ifndef PERSISTENT_TREAP_H
+#define PERSISTENT_TREAP_H
+
+// Persistent (path-copying) treap: Treap API with O(1) copies.
+#include "DynamicallySizedArray.h"
+#include "RefCountedArena.h"
+#include "TreapPriority.h"
+#include <cassert>
+
+/**
+ * PersistentTreapNode
+ * An immutable treap node. Once linked into a tree its fields never change,
+ * so any number of trees can share it; refs counts the parents and tree
+ * roots pointing at it.
+ */
+template <typename K, typename V> struct PersistentTreapNode {
+    K key;
+    V value;
+
+    unsigned int priority; // heap key (smaller = higher priority)
+    int subtree_size;      // size of subtree rooted here
+
+    PersistentTreapNode* left;
+    PersistentTreapNode* right; // Also links the arena's free list.
+    int refs;
+
+    PersistentTreapNode()
+        : key(), value(), priority(0), subtree_size(0), left(0), right(0),
+          refs(0) {}
+};
+
+template <typename K, typename V> class PersistentTreap;
+
+/**
+ * PersistentTreapCursor
+ * A position in a PersistentTreap, stored as the root-to-node path (shared
+ * nodes have no single parent, so the path replaces parent pointers). An
+ * empty path is the unset cursor.
+ *
+ * A cursor is valid until its tree is next modified; set_value() refreshes
+ * the cursor it is given.
+ */
+template <typename K, typename V> class PersistentTreapCursor {
+    friend class PersistentTreap<K, V>;
+    typedef PersistentTreapNode<K, V> PNode;
+
+    DynamicallySizedArray<PNode*> _path;
+
+  public:
+    // Whether the cursor points at a node.
+    bool is_set() const {
+        return !_path.empty();
+    }
+
+    // Key of the node (the cursor must be set).
+    K const& key() const {
+        assert(is_set());
+        return _path.back()->key;
+    }
+
+    // Value of the node (the cursor must be set).
+    V const& value() const {
+        assert(is_set());
+        return _path.back()->value;
+    }
+};
+
+/**
+ * PersistentTreap
+ * A treap with the Treap<K,V> API whose nodes are immutable and shared
+ * between copies. Updates copy the nodes on the search path (plus the split
+ * or join spines) and share everything else, so:
+ *  - copy construction and assignment are O(1) snapshots,
+ *  - insert, erase and set_value allocate O(log n) nodes (expected).
+ *
+ * Cursors are PersistentTreapCursor paths instead of node pointers. Since
+ * nodes are shared, values are changed through set_value(), not in place.
+ *
+ * Nodes come from a RefCountedArena shared by a tree and the copies made
+ * from it (a family), created by the first and freed with the last.
+ * Not thread-safe.
+ */
+template <typename K, typename V> class PersistentTreap {
+  public:
+    typedef PersistentTreapCursor<K, V> cursor;
+
+  private:
+    typedef PersistentTreapNode<K, V> PNode;
+    typedef RefCountedArena<PNode> Arena;
+
+    Arena* _arena; // Shared with the trees this one was copied from / to.
+    PNode* _root;
+    TreapPriorities _priorities;
+
+    static int get_subtree_size(PNode const* node) {
+        return (node == 0) ? 0 : node->subtree_size;
+    }
+
+    /**
+     * @brief Hands out a fresh node with one reference.
+     *
+     * @param key The node's key.
+     * @param value The node's value.
+     * @param priority The node's heap priority.
+     * @param left Left child (its reference is taken over by the node).
+     * @param right Right child (its reference is taken over by the node).
+     *
+     * @return The new node, with subtree_size computed.
+     */
+    PNode* make(K const& key, V const& value, unsigned int priority,
+                PNode* left, PNode* right) {
+        PNode* node = _arena->allocate();
+        node->key = key;
+        node->value = value;
+        node->priority = priority;
+        node->left = left;
+        node->right = right;
+        node->subtree_size =
+            1 + get_subtree_size(left) + get_subtree_size(right);
+        return node;
+    }
+
+    // Copy of node with new children (whose references it takes over).
+    PNode* copy_with(PNode const* node, PNode* left, PNode* right) {
+        return make(node->key, node->value, node->priority, left, right);
+    }
+
+    /**
+     * @brief Splits a subtree into keys < key and keys >= key without
+     * modifying it: only the nodes on the search path are copied.
+     *
+     * @param tree_node Root of the subtree (borrowed, may be NULL).
+     * @param key The split key.
+     * @param left_root Receives a new reference to the nodes with keys < key.
+     * @param right_root Receives a new reference to the nodes with keys >=
+     * key.
+     */
+    void split_nodes(PNode* tree_node, K const& key, PNode*& left_root,
+                     PNode*& right_root) {
+        if (tree_node == 0) {
+            left_root = 0;
+            right_root = 0;
+            return;
+        }
+        if (tree_node->key < key) {
+            PNode* middle;
+            split_nodes(tree_node->right, key, middle, right_root);
+            Arena::retain(tree_node->left);
+            left_root = copy_with(tree_node, tree_node->left, middle);
+        } else {
+            PNode* middle;
+            split_nodes(tree_node->left, key, left_root, middle);
+            Arena::retain(tree_node->right);
+            right_root = copy_with(tree_node, middle, tree_node->right);
+        }
+    }
+
+    /**
+     * @brief Joins two subtrees (all keys of left_root smaller than all keys
+     * of right_root) without modifying them: only the nodes on the inner
+     * spines are copied.
+     *
+     * @return A new reference to the joined subtree.
+     */
+    PNode* join_nodes(PNode* left_root, PNode* right_root) {
+        if (left_root == 0) {
+            Arena::retain(right_root);
+            return right_root;
+        }
+        if (right_root == 0) {
+            Arena::retain(left_root);
+            return left_root;
+        }
+        if (left_root->priority < right_root->priority) {
+            Arena::retain(left_root->left);
+            return copy_with(left_root, left_root->left,
+                             join_nodes(left_root->right, right_root));
+        }
+        Arena::retain(right_root->right);
+        return copy_with(right_root, join_nodes(left_root, right_root->left),
+                         right_root->right);
+    }
+
+    /**
+     * @brief Inserts a key that is not in the subtree, copying the path down
+     * to where the new node's priority places it.
+     *
+     * @return A new reference to the updated subtree.
+     */
+    PNode* insert_node(PNode* tree_node, K const& key, V const& value,
+                       unsigned int priority) {
+        if (tree_node == 0 || priority < tree_node->priority) {
+            PNode* left_root;
+            PNode* right_root;
+            split_nodes(tree_node, key, left_root, right_root);
+            return make(key, value, priority, left_root, right_root);
+        }
+        if (key < tree_node->key) {
+            Arena::retain(tree_node->right);
+            return copy_with(
+                tree_node, insert_node(tree_node->left, key, value, priority),
+                tree_node->right);
+        }
+        Arena::retain(tree_node->left);
+        return copy_with(tree_node, tree_node->left,
+                         insert_node(tree_node->right, key, value, priority));
+    }
+
+    /**
+     * @brief Removes a key that is in the subtree, copying the path down to
+     * it and replacing it with the join of its children.
+     *
+     * @return A new reference to the updated subtree.
+     */
+    PNode* erase_node(PNode* tree_node, K const& key) {
+        assert(tree_node != 0);
+        if (key < tree_node->key) {
+            Arena::retain(tree_node->right);
+            return copy_with(tree_node, erase_node(tree_node->left, key),
+                             tree_node->right);
+        }
+        if (tree_node->key < key) {
+            Arena::retain(tree_node->left);
+            return copy_with(tree_node, tree_node->left,
+                             erase_node(tree_node->right, key));
+        }
+        return join_nodes(tree_node->left, tree_node->right);
+    }
+
+    // Makes new_root (a new reference) the root, dropping the old one.
+    void replace_root(PNode* new_root) {
+        _arena->release(_root);
+        _root = new_root;
+    }
+
+    /**
+     * @brief Fills result with the path from the root down to key, or leaves
+     * it empty if key is not in the tree.
+     */
+    void path_to(K const& key, cursor& result) const {
+        result._path.resize(0);
+        PNode* current = _root;
+        while (current != 0) {
+            result._path.push_back(current);
+            if (key < current->key) {
+                current = current->left;
+            } else if (current->key < key) {
+                current = current->right;
+            } else {
+                return;
+            }
+        }
+        result._path.resize(0);
+    }
+
+  public:
+    // Constructor
+    PersistentTreap() : _arena(new Arena()), _root(0), _priorities() {}
+
+    // Copy Constructor: O(1) snapshot sharing all nodes (and the arena).
+    PersistentTreap(const PersistentTreap& other)
+        : _arena(other._arena->share()), _root(other._root), _priorities() {
+        Arena::retain(_root);
+    }
+
+    // Assignment operator: O(1) snapshot sharing all nodes; this tree joins
+    // other's family.
+    PersistentTreap& operator=(const PersistentTreap& other) {
+        if (this != &other) {
+            Arena::retain(other._root); // Retain first: roots may be shared.
+            replace_root(other._root);
+            if (_arena != other._arena) {
+                _arena->drop();
+                _arena = other._arena->share();
+            }
+            _priorities = other._priorities;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~PersistentTreap() {
+        _arena->release(_root);
+        _arena->drop();
+    }
+
+    /**
+     * @brief Finds the node with the given key.
+     *
+     * @param key The key to find.
+     *
+     * @return A cursor at the node with the given key, or an unset cursor.
+     */
+    cursor find(const K& key) const {
+        cursor result;
+        path_to(key, result);
+        return result;
+    }
+
+    /**
+     * @brief Finds the node with the smallest key >= key.
+     *
+     * @param key The key to compare against.
+     *
+     * @return A cursor at the first node with key >= key, or an unset cursor.
+     */
+    cursor lower_bound(const K& key) const {
+        cursor result;
+        int depth = 0; // Path length up to the best candidate so far.
+        PNode* current = _root;
+        while (current != 0) {
+            result._path.push_back(current);
+            if (current->key < key) {
+                current = current->right;
+            } else {
+                depth = result._path.size();
+                current = current->left;
+            }
+        }
+        result._path.resize(depth);
+        return result;
+    }
+
+    /**
+     * @brief Finds the node with the smallest key > key.
+     *
+     * @param key The key to compare against.
+     *
+     * @return A cursor at the first node with key > key, or an unset cursor.
+     */
+    cursor upper_bound(const K& key) const {
+        cursor result;
+        int depth = 0;
+        PNode* current = _root;
+        while (current != 0) {
+            result._path.push_back(current);
+            if (key < current->key) {
+                depth = result._path.size();
+                current = current->left;
+            } else {
+                current = current->right;
+            }
+        }
+        result._path.resize(depth);
+        return result;
+    }
+
+    /**
+     * @brief Inserts a key-value pair, or finds the node if the key exists.
+     * Copies the O(log n) nodes on the insertion path.
+     *
+     * @param key The key to insert.
+     * @param value The value to insert.
+     *
+     * @return A cursor at the inserted (or existing) node.
+     */
+    cursor insert(const K& key, const V& value) {
+        cursor result;
+        path_to(key, result);
+        if (result.is_set()) {
+            return result;
+        }
+        replace_root(insert_node(_root, key, value, _priorities.next()));
+        path_to(key, result);
+        return result;
+    }
+
+    /**
+     * @brief Erases the node at a cursor. Copies the O(log n) nodes on its
+     * path and the join spines below it.
+     *
+     * @param position A cursor into this tree (safe if unset).
+     */
+    void erase(const cursor& position) {
+        if (!position.is_set()) {
+            return;
+        }
+        replace_root(erase_node(_root, position.key()));
+    }
+
+    /**
+     * @brief Replaces the value at a cursor. Copies the O(log n) nodes on its
+     * path, so other trees sharing them keep the old value.
+     *
+     * @param position A set cursor into this tree; refreshed to the copy.
+     * @param value The new value.
+     */
+    void set_value(cursor& position, const V& value) {
+        assert(position.is_set());
+        DynamicallySizedArray<PNode*>& path = position._path;
+        PNode* old_below = 0; // path[i + 1] before it was replaced.
+        PNode* below = 0;     // New copy of path[i + 1].
+        for (int i = path.size() - 1; i >= 0; --i) {
+            PNode* node = path[i];
+            PNode* copy;
+            if (i == path.size() - 1) {
+                Arena::retain(node->left);
+                Arena::retain(node->right);
+                copy = make(node->key, value, node->priority, node->left,
+                            node->right);
+            } else if (old_below == node->left) {
+                Arena::retain(node->right);
+                copy = copy_with(node, below, node->right);
+            } else {
+                Arena::retain(node->left);
+                copy = copy_with(node, node->left, below);
+            }
+            path[i] = copy;
+            old_below = node;
+            below = copy;
+        }
+        replace_root(below);
+    }
+
+    /**
+     * @brief Finds the node with the smallest key.
+     *
+     * @return A cursor at the smallest key, or an unset cursor if empty.
+     */
+    cursor front() const {
+        cursor result;
+        for (PNode* current = _root; current != 0; current = current->left) {
+            result._path.push_back(current);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Finds the node with the largest key.
+     *
+     * @return A cursor at the largest key, or an unset cursor if empty.
+     */
+    cursor back() const {
+        cursor result;
+        for (PNode* current = _root; current != 0; current = current->right) {
+            result._path.push_back(current);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Moves a cursor to its in-order successor by walking its path in
+     * place: down the right subtree if there is one, otherwise up to the
+     * first ancestor reached from its left child. Amortized O(1) when
+     * iterating over the whole tree; O(log n) expected for one step.
+     *
+     * @param position The cursor to move (left unset if there is no
+     * successor; safe if unset).
+     */
+    void advance(cursor& position) const {
+        DynamicallySizedArray<PNode*>& path = position._path;
+        if (path.empty()) {
+            return;
+        }
+        PNode* current = path.back()->right;
+        if (current != 0) {
+            for (; current != 0; current = current->left) {
+                path.push_back(current);
+            }
+            return;
+        }
+        PNode* child = path.back();
+        path.pop_back();
+        while (!path.empty() && path.back()->right == child) {
+            child = path.back();
+            path.pop_back();
+        }
+    }
+
+    /**
+     * @brief Moves a cursor to its in-order predecessor in place (mirror
+     * image of advance()).
+     *
+     * @param position The cursor to move (left unset if there is no
+     * predecessor; safe if unset).
+     */
+    void retreat(cursor& position) const {
+        DynamicallySizedArray<PNode*>& path = position._path;
+        if (path.empty()) {
+            return;
+        }
+        PNode* current = path.back()->left;
+        if (current != 0) {
+            for (; current != 0; current = current->right) {
+                path.push_back(current);
+            }
+            return;
+        }
+        PNode* child = path.back();
+        path.pop_back();
+        while (!path.empty() && path.back()->left == child) {
+            child = path.back();
+            path.pop_back();
+        }
+    }
+
+    /**
+     * @brief Finds the in-order successor. Copies the cursor's path first,
+     * so each call is O(log n) expected; use advance() to iterate.
+     *
+     * @param position The cursor to start from (safe if unset).
+     *
+     * @return A cursor at the successor, or an unset cursor if none exists.
+     */
+    cursor successor(const cursor& position) const {
+        cursor result = position;
+        advance(result);
+        return result;
+    }
+
+    /**
+     * @brief Finds the in-order predecessor. Copies the cursor's path first,
+     * so each call is O(log n) expected; use retreat() to iterate.
+     *
+     * @param position The cursor to start from (safe if unset).
+     *
+     * @return A cursor at the predecessor, or an unset cursor if none exists.
+     */
+    cursor predecessor(const cursor& position) const {
+        cursor result = position;
+        retreat(result);
+        return result;
+    }
+
+    /**
+     * @brief Calculates the in-order rank of the node at a cursor from its
+     * path: every step to a right child passes a left subtree and a node.
+     *
+     * @param position The cursor.
+     *
+     * @return The 0-based rank of the node, or -1 if the cursor is unset.
+     */
+    int rank(const cursor& position) const {
+        DynamicallySizedArray<PNode*> const& path = position._path;
+        if (path.empty()) {
+            return -1;
+        }
+        int result = get_subtree_size(path.back()->left);
+        for (int i = 0; i + 1 < path.size(); ++i) {
+            if (path[i + 1] == path[i]->right) {
+                result += get_subtree_size(path[i]->left) + 1;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Finds the k-th smallest node (0-based).
+     *
+     * @param k The rank to look up.
+     *
+     * @return A cursor at the k-th node, or an unset cursor if k is out of
+     * range.
+     */
+    cursor kth(int k) const {
+        cursor result;
+        if (k < 0 || k >= size()) {
+            return result;
+        }
+        PNode* current = _root;
+        while (true) {
+            result._path.push_back(current);
+            int left_size = get_subtree_size(current->left);
+            if (k < left_size) {
+                current = current->left;
+            } else if (k == left_size) {
+                return result;
+            } else {
+                k -= left_size + 1;
+                current = current->right;
+            }
+        }
+    }
+
+    /**
+     * @brief Provides the number of nodes in the treap. O(1).
+     *
+     * @return The number of nodes in the treap.
+     */
+    int size() const {
+        return get_subtree_size(_root);
+    }
+
+    /**
+     * @brief Drops this tree's reference to its nodes. Nodes still shared
+     * with other trees stay alive; the rest go back to the arena.
+     */
+    void clear() {
+        replace_root(0);
+    }
+};
+
+#endif // PERSISTENT_TREAP_H
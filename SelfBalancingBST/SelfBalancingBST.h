@@ -2,8 +2,26 @@
 #define SELF_BALANCING_BST_H
 
 // Treap-based self-balancing BST.
+#include "EytzingerIndex.h"
+#include "TreapHashIndex.h"
+#include "TreapMonoid.h"
+#include "TreapPriority.h"
+#include <cassert>
 
-template <typename K, typename V> struct TreapNode {
+// Software prefetch hint for the batched lookups (a no-op where unsupported).
+#if defined(__GNUC__)
+#define TREAP_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define TREAP_PREFETCH(address) ((void)(address))
+#endif
+
+/**
+ * TreapNode
+ * With a Monoid (see TreapMonoid.h) the node also carries `aggregate`, the
+ * monoid aggregate of the values in its subtree.
+ */
+template <typename K, typename V, typename Monoid = TreapNoAggregate>
+struct TreapNode : TreapAggregateField<typename Monoid::value_type> {
     K key;
     V value;
 
@@ -19,10 +37,48 @@ template <typename K, typename V> struct TreapNode {
           right(0), parent(0) {}
 };
 
-template <typename K, typename V> class Treap {
+/**
+ * TreapSerialPool
+ * The task pool the sequential bulk operations run with: they pass a NULL
+ * TreapSerialPool*, so nothing is ever forked. ParallelTreap.h runs the same
+ * code on a ForkJoinPool. A pool type provides task_type (with a virtual
+ * run()), fork(task) and join(task).
+ */
+struct TreapSerialPool {
+    struct task_type {
+        virtual ~task_type() {}
+        virtual void run() = 0;
+    };
+
+    void fork(task_type& task) {
+        task.run();
+    }
+
+    void join(task_type&) {}
+};
+
+/**
+ * Treap
+ * Monoid adds range aggregates (see TreapMonoid.h); Index = TreapHashIndex
+ * adds a hash index from key to node for O(1) expected find() (see
+ * TreapHashIndex.h).
+ *
+ * With TreapHashIndex, the O(n) operations (copies, build_from_sorted,
+ * filter) rebuild the index as they finish. split and the set operations
+ * leave it stale instead; find() then searches the tree until
+ * rebuild_index() is called. Const calls never modify the tree.
+ */
+template <typename K, typename V, typename Monoid = TreapNoAggregate,
+          typename Index = TreapNoIndex>
+class Treap {
   private:
-    typedef TreapNode<K, V> TNode;
+    typedef TreapNode<K, V, Monoid> TNode;
+    typedef typename Monoid::value_type aggregate_type;
+    typedef TreapKeyIndex<Index, K, TNode> index_type;
     TNode* _root;
+    TreapPriorities _priorities; // This tree's priority stream.
+    index_type _index;           // Key -> node (empty for TreapNoIndex).
+    bool _index_stale;           // _index must be rebuilt before use.
 
     /**
      * @brief Helper function to get the size of the subtree rooted at the
@@ -42,7 +98,8 @@ template <typename K, typename V> class Treap {
     }
 
     /**
-     * @brief Helper function to update the subtree size of the given node.
+     * @brief Helper function to update the subtree size (and the monoid
+     * aggregate, if any) of the given node.
      *
      * Updates the size based on the sizes of its left and right children.
      * Called after any modification to the subtree so that sizer remain
@@ -54,7 +111,53 @@ template <typename K, typename V> class Treap {
         if (node != 0) {
             node->subtree_size = 1 + get_subtree_size(node->left) +
                                  get_subtree_size(node->right);
+            TreapAggregator<Monoid>::pull(node);
+        }
+    }
+
+    // Aggregate of a whole subtree (identity for NULL).
+    static aggregate_type subtree_aggregate(TNode* tree_node) {
+        return (tree_node == 0) ? Monoid::identity() : tree_node->aggregate;
+    }
+
+    /**
+     * @brief Aggregate of the keys < hi in a subtree: walking down, every
+     * node with key < hi contributes its left subtree and itself.
+     */
+    static aggregate_type aggregate_below(TNode* tree_node, const K& hi) {
+        aggregate_type result = Monoid::identity();
+        while (tree_node != 0) {
+            if (tree_node->key < hi) {
+                result = Monoid::combine(
+                    result,
+                    Monoid::combine(subtree_aggregate(tree_node->left),
+                                    Monoid::lift(tree_node->value)));
+                tree_node = tree_node->right;
+            } else {
+                tree_node = tree_node->left;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Aggregate of the keys >= lo in a subtree (mirror image of
+     * aggregate_below()).
+     */
+    static aggregate_type aggregate_from(TNode* tree_node, const K& lo) {
+        aggregate_type result = Monoid::identity();
+        while (tree_node != 0) {
+            if (tree_node->key < lo) {
+                tree_node = tree_node->right;
+            } else {
+                result = Monoid::combine(
+                    Monoid::combine(Monoid::lift(tree_node->value),
+                                    subtree_aggregate(tree_node->right)),
+                    result);
+                tree_node = tree_node->left;
+            }
         }
+        return result;
     }
 
     /**
@@ -65,12 +168,8 @@ template <typename K, typename V> class Treap {
      *
      * @return The next priority value to be assigned to a new node.
      */
-    static unsigned int next_priority() {
-        // Basic way to generate a random number that I toootally came up with
-        // myself.
-        static unsigned int state = 2463534242u;
-        state = state * 1103515245u + 12345u;
-        return state;
+    unsigned int next_priority() {
+        return _priorities.next();
     }
 
     /**
@@ -214,15 +313,646 @@ template <typename K, typename V> class Treap {
         return new_tree_node;
     }
 
+    /**
+     * @brief Recomputes subtree_size bottom-up for a whole subtree (used
+     * after building a tree without rotations).
+     *
+     * @param tree_node Root of the subtree (may be NULL).
+     */
+    static void fix_sizes(TNode* tree_node) {
+        if (tree_node == 0) {
+            return;
+        }
+        fix_sizes(tree_node->left);
+        fix_sizes(tree_node->right);
+        pull(tree_node);
+    }
+
+    // Sets the parent pointer of child if it exists.
+    static void set_parent(TNode* child, TNode* parent_node) {
+        if (child != 0) {
+            child->parent = parent_node;
+        }
+    }
+
+    /**
+     * @brief Splits the subtree rooted at tree_node by key.
+     *
+     * Walks one root-to-leaf path, re-linking the nodes it passes into the
+     * two result trees, so it is O(depth) and allocates nothing. Parent
+     * pointers inside the results are fixed up; the result roots' parent
+     * pointers are left to the caller.
+     *
+     * @param tree_node Root of the subtree to split (may be NULL).
+     * @param key The split key.
+     * @param left_root Receives the root of the nodes with keys < key.
+     * @param right_root Receives the root of the nodes with keys >= key.
+     */
+    static void split_nodes(TNode* tree_node, const K& key, TNode*& left_root,
+                            TNode*& right_root) {
+        if (tree_node == 0) {
+            left_root = 0;
+            right_root = 0;
+            return;
+        }
+        if (tree_node->key < key) {
+            split_nodes(tree_node->right, key, tree_node->right, right_root);
+            set_parent(tree_node->right, tree_node);
+            pull(tree_node);
+            left_root = tree_node;
+        } else {
+            split_nodes(tree_node->left, key, left_root, tree_node->left);
+            set_parent(tree_node->left, tree_node);
+            pull(tree_node);
+            right_root = tree_node;
+        }
+    }
+
+    /**
+     * @brief Like split_nodes(), but also takes the node whose key equals
+     * key (if any) out of the tree.
+     *
+     * @param equal_node Receives the detached node with the given key, or
+     * NULL. Its children and parent are cleared.
+     */
+    static void split_nodes3(TNode* tree_node, const K& key, TNode*& left_root,
+                             TNode*& equal_node, TNode*& right_root) {
+        if (tree_node == 0) {
+            left_root = 0;
+            equal_node = 0;
+            right_root = 0;
+            return;
+        }
+        if (tree_node->key < key) {
+            split_nodes3(tree_node->right, key, tree_node->right, equal_node,
+                         right_root);
+            set_parent(tree_node->right, tree_node);
+            pull(tree_node);
+            left_root = tree_node;
+        } else if (key < tree_node->key) {
+            split_nodes3(tree_node->left, key, left_root, equal_node,
+                         tree_node->left);
+            set_parent(tree_node->left, tree_node);
+            pull(tree_node);
+            right_root = tree_node;
+        } else {
+            left_root = tree_node->left;
+            right_root = tree_node->right;
+            equal_node = tree_node;
+            equal_node->left = 0;
+            equal_node->right = 0;
+            equal_node->parent = 0;
+            pull(equal_node);
+        }
+    }
+
+    /**
+     * @brief Joins two subtrees where every key in left_root is smaller than
+     * every key in right_root, keeping the heap order on priorities.
+     *
+     * Walks down the right spine of left_root and the left spine of
+     * right_root, so it is O(depth of both). The result root's parent
+     * pointer is left to the caller.
+     *
+     * @return Root of the joined subtree.
+     */
+    static TNode* join_nodes(TNode* left_root, TNode* right_root) {
+        if (left_root == 0) {
+            return right_root;
+        }
+        if (right_root == 0) {
+            return left_root;
+        }
+        if (left_root->priority < right_root->priority) {
+            left_root->right = join_nodes(left_root->right, right_root);
+            left_root->right->parent = left_root;
+            pull(left_root);
+            return left_root;
+        }
+        right_root->left = join_nodes(left_root, right_root->left);
+        right_root->left->parent = right_root;
+        pull(right_root);
+        return right_root;
+    }
+
+    /**
+     * @brief Joins left_root, mid and right_root (in key order) when mid has
+     * a smaller priority than every node in the two subtrees: mid simply
+     * becomes their parent.
+     *
+     * @return mid, as the root of the joined subtree.
+     */
+    static TNode* join_with_root(TNode* left_root, TNode* mid,
+                                 TNode* right_root) {
+        mid->left = left_root;
+        mid->right = right_root;
+        set_parent(left_root, mid);
+        set_parent(right_root, mid);
+        pull(mid);
+        return mid;
+    }
+
+    // Set operation and filter subproblems smaller than this run on the
+    // calling thread instead of being forked.
+    static const int PARALLEL_GRAIN = 1 << 14;
+
+    // One recursive set operation call, as a task of Pool.
+    template <typename Pool> struct SetOperationTask : Pool::task_type {
+        typedef TNode* (*Operation)(TNode*, TNode*, Pool*);
+        Operation operation;
+        TNode* first_tree;
+        TNode* second_tree;
+        Pool* pool;
+        TNode* result;
+
+        SetOperationTask(Operation op, TNode* first, TNode* second,
+                         Pool* task_pool)
+            : operation(op), first_tree(first), second_tree(second),
+              pool(task_pool), result(0) {}
+
+        void run() {
+            result = operation(first_tree, second_tree, pool);
+        }
+    };
+
+    /**
+     * @brief Runs a set operation on the two independent halves left by a
+     * split: the right pair is forked to pool when it has at least
+     * PARALLEL_GRAIN nodes, the left pair runs on this thread.
+     *
+     * @param pool The task pool, or NULL to run both on this thread.
+     */
+    template <typename Pool>
+    static void run_halves(TNode* (*operation)(TNode*, TNode*, Pool*),
+                           TNode* first_left, TNode* second_left,
+                           TNode*& result_left, TNode* first_right,
+                           TNode* second_right, TNode*& result_right,
+                           Pool* pool) {
+        if (pool != 0 && get_subtree_size(first_right) +
+                                 get_subtree_size(second_right) >=
+                             PARALLEL_GRAIN) {
+            SetOperationTask<Pool> task(operation, first_right, second_right,
+                                        pool);
+            pool->fork(task);
+            result_left = operation(first_left, second_left, pool);
+            pool->join(task);
+            result_right = task.result;
+        } else {
+            result_left = operation(first_left, second_left, pool);
+            result_right = operation(first_right, second_right, pool);
+        }
+    }
+
+    /**
+     * @brief When a set operation's pivot comes from second_tree and
+     * first_tree has the same key, puts first_tree's node in its place: the
+     * node takes the pivot's priority, which beats every remaining node, and
+     * the pivot is deleted. The caller has already taken the pivot's
+     * children.
+     *
+     * @return first_node, the new pivot.
+     */
+    static TNode* keep_first_node(TNode* pivot, TNode* first_node) {
+        first_node->priority = pivot->priority;
+        delete pivot;
+        return first_node;
+    }
+
+    /**
+     * @brief Union of two subtrees (join-based). Consumes both; when a key
+     * is in both, the node from first_tree is kept (so pointers into
+     * first_tree stay valid) and the one from second_tree is deleted.
+     *
+     * The root with the smaller priority is the pivot: the other tree is
+     * split by its key and the halves are united recursively. Since the
+     * pivot's priority beats every other node, re-joining is O(1). Total
+     * work is O(m log(n / m + 1)) expected for sizes m <= n. The two halves
+     * are disjoint, so with a pool they are united in parallel.
+     *
+     * @return Root of the union.
+     */
+    template <typename Pool>
+    static TNode* union_nodes(TNode* first_tree, TNode* second_tree,
+                              Pool* pool) {
+        if (first_tree == 0) {
+            return second_tree;
+        }
+        if (second_tree == 0) {
+            return first_tree;
+        }
+        bool first_is_pivot = first_tree->priority <= second_tree->priority;
+        TNode* pivot = first_is_pivot ? first_tree : second_tree;
+        TNode* other = first_is_pivot ? second_tree : first_tree;
+
+        TNode* other_left;
+        TNode* duplicate;
+        TNode* other_right;
+        split_nodes3(other, pivot->key, other_left, duplicate, other_right);
+        TNode* pivot_left = pivot->left;
+        TNode* pivot_right = pivot->right;
+        if (duplicate != 0) {
+            if (first_is_pivot) {
+                delete duplicate;
+            } else {
+                pivot = keep_first_node(pivot, duplicate);
+            }
+        }
+
+        TNode* first_left = first_is_pivot ? pivot_left : other_left;
+        TNode* second_left = first_is_pivot ? other_left : pivot_left;
+        TNode* first_right = first_is_pivot ? pivot_right : other_right;
+        TNode* second_right = first_is_pivot ? other_right : pivot_right;
+        TNode* united_left;
+        TNode* united_right;
+        run_halves(union_nodes<Pool>, first_left, second_left, united_left,
+                   first_right, second_right, united_right, pool);
+        return join_with_root(united_left, pivot, united_right);
+    }
+
+    /**
+     * @brief Intersection of two subtrees (join-based). Consumes both; the
+     * kept nodes are first_tree's (so pointers to them stay valid).
+     * O(m log(n / m + 1)) expected.
+     *
+     * @return Root of the intersection.
+     */
+    template <typename Pool>
+    static TNode* intersection_nodes(TNode* first_tree, TNode* second_tree,
+                                     Pool* pool) {
+        if (first_tree == 0 || second_tree == 0) {
+            destroy_subtree(first_tree);
+            destroy_subtree(second_tree);
+            return 0;
+        }
+        bool first_is_pivot = first_tree->priority <= second_tree->priority;
+        TNode* pivot = first_is_pivot ? first_tree : second_tree;
+        TNode* other = first_is_pivot ? second_tree : first_tree;
+
+        TNode* other_left;
+        TNode* duplicate;
+        TNode* other_right;
+        split_nodes3(other, pivot->key, other_left, duplicate, other_right);
+
+        TNode* first_left = first_is_pivot ? pivot->left : other_left;
+        TNode* second_left = first_is_pivot ? other_left : pivot->left;
+        TNode* first_right = first_is_pivot ? pivot->right : other_right;
+        TNode* second_right = first_is_pivot ? other_right : pivot->right;
+        TNode* common_left;
+        TNode* common_right;
+        run_halves(intersection_nodes<Pool>, first_left, second_left,
+                   common_left, first_right, second_right, common_right, pool);
+
+        if (duplicate == 0) {
+            delete pivot;
+            return join_nodes(common_left, common_right);
+        }
+        if (first_is_pivot) {
+            delete duplicate;
+        } else {
+            pivot = keep_first_node(pivot, duplicate);
+        }
+        return join_with_root(common_left, pivot, common_right);
+    }
+
+    /**
+     * @brief Difference of two subtrees: the nodes of first_tree whose keys
+     * are not in second_tree (join-based). Consumes both.
+     * O(m log(n / m + 1)) expected.
+     *
+     * @return Root of the difference.
+     */
+    template <typename Pool>
+    static TNode* difference_nodes(TNode* first_tree, TNode* second_tree,
+                                   Pool* pool) {
+        if (first_tree == 0 || second_tree == 0) {
+            destroy_subtree(second_tree);
+            return first_tree;
+        }
+        // Split first_tree by second_tree's root; the matching node (if any)
+        // is dropped together with the root.
+        TNode* first_left;
+        TNode* duplicate;
+        TNode* first_right;
+        split_nodes3(first_tree, second_tree->key, first_left, duplicate,
+                     first_right);
+        delete duplicate;
+
+        TNode* second_left = second_tree->left;
+        TNode* second_right = second_tree->right;
+        delete second_tree;
+        TNode* kept_left;
+        TNode* kept_right;
+        run_halves(difference_nodes<Pool>, first_left, second_left, kept_left,
+                   first_right, second_right, kept_right, pool);
+        return join_nodes(kept_left, kept_right);
+    }
+
+    /**
+     * @brief Builds the Cartesian tree of keys[first..last), giving the
+     * entry at index i the priority priorities->of(base + i).
+     *
+     * Left to right, each new node climbs the right spine (via parent
+     * pointers) past the nodes with larger priorities and adopts them as its
+     * left subtree; every node is climbed past at most once, so this is
+     * O(last - first). With a pool, large ranges are halved, built in
+     * parallel and joined in O(log n): a priority depends only on the
+     * index, so the result is the same tree.
+     *
+     * @return Root of the tree (NULL for an empty range).
+     */
+    template <typename Pool>
+    static TNode* build_nodes(const K* keys, const V* values, int first,
+                              int last, const TreapPriorities* priorities,
+                              unsigned int base, Pool* pool) {
+        if (pool != 0 && last - first >= 2 * PARALLEL_GRAIN) {
+            int mid = first + (last - first) / 2;
+            BuildTask<Pool> task(keys, values, mid, last, priorities, base,
+                                 pool);
+            pool->fork(task);
+            TNode* left_root = build_nodes(keys, values, first, mid,
+                                           priorities, base, pool);
+            pool->join(task);
+            return join_nodes(left_root, task.result);
+        }
+
+        TNode* root = 0;
+        TNode* last_node = 0; // Bottom of the right spine.
+        for (int i = first; i < last; ++i) {
+            assert(i == 0 || keys[i - 1] < keys[i]);
+            TNode* new_node = new TNode(keys[i], values[i],
+                                        priorities->of(base + i));
+            TNode* adopted = 0;
+            while (last_node != 0 && new_node->priority < last_node->priority) {
+                adopted = last_node;
+                last_node = last_node->parent;
+            }
+            new_node->left = adopted;
+            set_parent(adopted, new_node);
+            new_node->parent = last_node;
+            if (last_node == 0) {
+                root = new_node;
+            } else {
+                last_node->right = new_node;
+            }
+            last_node = new_node;
+        }
+        fix_sizes(root);
+        return root;
+    }
+
+    // One build_nodes() call, as a task of Pool.
+    template <typename Pool> struct BuildTask : Pool::task_type {
+        const K* keys;
+        const V* values;
+        int first;
+        int last;
+        const TreapPriorities* priorities;
+        unsigned int base;
+        Pool* pool;
+        TNode* result;
+
+        BuildTask(const K* task_keys, const V* task_values, int task_first,
+                  int task_last, const TreapPriorities* task_priorities,
+                  unsigned int task_base, Pool* task_pool)
+            : keys(task_keys), values(task_values), first(task_first),
+              last(task_last), priorities(task_priorities), base(task_base),
+              pool(task_pool), result(0) {}
+
+        void run() {
+            result = build_nodes(keys, values, first, last, priorities, base,
+                                 pool);
+        }
+    };
+
+    /**
+     * @brief Removes the nodes for which pred(key, value) is false from a
+     * subtree. Both children are filtered (in parallel with a pool), then a
+     * kept node becomes the root of the two results again and a dropped one
+     * is replaced by their join. O(n) work.
+     *
+     * @return Root of the kept nodes.
+     */
+    template <typename Predicate, typename Pool>
+    static TNode* filter_nodes(TNode* tree_node, Predicate& pred,
+                               Pool* pool) {
+        if (tree_node == 0) {
+            return 0;
+        }
+        TNode* kept_left;
+        TNode* kept_right;
+        if (pool != 0 && get_subtree_size(tree_node->right) >= PARALLEL_GRAIN) {
+            FilterTask<Predicate, Pool> task(tree_node->right, pred, pool);
+            pool->fork(task);
+            kept_left = filter_nodes(tree_node->left, pred, pool);
+            pool->join(task);
+            kept_right = task.result;
+        } else {
+            kept_left = filter_nodes(tree_node->left, pred, pool);
+            kept_right = filter_nodes(tree_node->right, pred, pool);
+        }
+        if (pred(tree_node->key, tree_node->value)) {
+            return join_with_root(kept_left, tree_node, kept_right);
+        }
+        delete tree_node;
+        return join_nodes(kept_left, kept_right);
+    }
+
+    // One filter_nodes() call, as a task of Pool.
+    template <typename Predicate, typename Pool>
+    struct FilterTask : Pool::task_type {
+        TNode* tree_node;
+        Predicate& pred;
+        Pool* pool;
+        TNode* result;
+
+        FilterTask(TNode* task_node, Predicate& task_pred, Pool* task_pool)
+            : tree_node(task_node), pred(task_pred), pool(task_pool),
+              result(0) {}
+
+        void run() {
+            result = filter_nodes(tree_node, pred, pool);
+        }
+    };
+
+    // Makes root the tree's root (clearing its parent pointer).
+    void set_root(TNode* root) {
+        _root = root;
+        set_parent(_root, 0);
+    }
+
+    // Adds every node of a subtree to the find() index.
+    void index_subtree(TNode* tree_node) {
+        if (!index_type::ENABLED || tree_node == 0) {
+            return;
+        }
+        index_subtree(tree_node->left);
+        _index.insert(tree_node);
+        index_subtree(tree_node->right);
+    }
+
+    // Removes every node of a subtree from the find() index.
+    void unindex_subtree(TNode* tree_node) {
+        if (!index_type::ENABLED || tree_node == 0) {
+            return;
+        }
+        unindex_subtree(tree_node->left);
+        _index.erase(tree_node->key);
+        unindex_subtree(tree_node->right);
+    }
+
+    /**
+     * @brief Drops the find() index after a bulk operation changed the node
+     * set; find() searches the tree until rebuild_index(). Until then
+     * insert() and erase() skip it, so a run of bulk operations pays for one
+     * rebuild.
+     */
+    void invalidate_index() {
+        _index.clear();
+        _index_stale = index_type::ENABLED;
+    }
+
+    // Empties the find() index of a treap that has become empty.
+    void reset_index() {
+        _index.clear();
+        _index_stale = false;
+    }
+
+    // Indexes every node after an operation that already costs O(n).
+    void reindex() {
+        invalidate_index();
+        rebuild_index();
+    }
+
+    /**
+     * @brief Finger search: the first node that is not "before" the target,
+     * starting from finger instead of the root.
+     *
+     * A node is before the target if node->key < key (or <= key when
+     * strict). From the finger the search climbs via parent until the
+     * target's position must lie in the current subtree: a node that is
+     * before the target and is the left child of a parent that is not, or a
+     * node that is not before the target and is the right child of a parent
+     * that is. It then descends as usual. For a target d positions away from
+     * the finger this visits expected O(log d) nodes.
+     *
+     * @param finger Node to start from (NULL starts at the root).
+     * @param key The target key.
+     * @param strict false for lower_bound (key <= result), true for
+     * upper_bound (key < result).
+     *
+     * @return The first node not before the target, or NULL if none.
+     */
+    TNode* finger_bound(TNode* finger, const K& key, bool strict) const {
+        TNode* curr_node = (finger == 0) ? _root : finger;
+        TNode* best_node = 0;
+        while (curr_node != 0 && curr_node->parent != 0) {
+            TNode* parent = curr_node->parent;
+            bool curr_before = strict ? !(key < curr_node->key)
+                                      : curr_node->key < key;
+            bool parent_before =
+                strict ? !(key < parent->key) : parent->key < key;
+            if (curr_before && !parent_before && parent->left == curr_node) {
+                best_node = parent; // Answer is parent or in curr's subtree.
+                break;
+            }
+            if (!curr_before && parent_before && parent->right == curr_node) {
+                break; // Answer is curr or in its left subtree.
+            }
+            curr_node = parent;
+        }
+        while (curr_node != 0) {
+            bool before = strict ? !(key < curr_node->key)
+                                 : curr_node->key < key;
+            if (before) {
+                curr_node = curr_node->right;
+            } else {
+                best_node = curr_node;
+                curr_node = curr_node->left;
+            }
+        }
+        return best_node;
+    }
+
+    /**
+     * @brief Runs n independent lower_bound descents interleaved, BATCH_LANES
+     * at a time.
+     *
+     * Each lane advances one level per round and prefetches the child it
+     * will read next round. The cache misses of the lanes overlap instead of
+     * being paid one after another. A lane that finishes picks up the next
+     * key right away, so all lanes stay busy until the keys run out.
+     *
+     * @param keys The keys to look up.
+     * @param n Number of keys.
+     * @param out Receives one node per key.
+     * @param exact true for find (NULL unless the key matches), false for
+     * lower_bound.
+     */
+    void bound_batch(const K* keys, int n, TNode** out, bool exact) const {
+        static const int BATCH_LANES = 8;
+        TNode* curr_nodes[BATCH_LANES];
+        TNode* best_nodes[BATCH_LANES];
+        int indices[BATCH_LANES]; // Key index per lane, -1 when idle.
+
+        int next_index = 0;
+        int active = 0;
+        for (int lane = 0; lane < BATCH_LANES; ++lane) {
+            indices[lane] = -1;
+            if (next_index < n) {
+                indices[lane] = next_index++;
+                curr_nodes[lane] = _root;
+                best_nodes[lane] = 0;
+                ++active;
+            }
+        }
+        while (active > 0) {
+            for (int lane = 0; lane < BATCH_LANES; ++lane) {
+                int index = indices[lane];
+                if (index < 0) {
+                    continue;
+                }
+                const K& key = keys[index];
+                TNode* curr_node = curr_nodes[lane];
+                if (curr_node == 0) {
+                    TNode* best_node = best_nodes[lane];
+                    if (exact && best_node != 0 && key < best_node->key) {
+                        best_node = 0;
+                    }
+                    out[index] = best_node;
+                    if (next_index < n) {
+                        indices[lane] = next_index++;
+                        curr_nodes[lane] = _root;
+                        best_nodes[lane] = 0;
+                    } else {
+                        indices[lane] = -1;
+                        --active;
+                    }
+                    continue;
+                }
+                if (curr_node->key < key) {
+                    curr_node = curr_node->right;
+                } else {
+                    best_nodes[lane] = curr_node;
+                    curr_node = curr_node->left;
+                }
+                TREAP_PREFETCH(curr_node);
+                curr_nodes[lane] = curr_node;
+            }
+        }
+    }
+
   public:
     // typedef TreapNode<K, V> TNode;
 
     // Constructor
-    Treap() : _root(0) {}
+    Treap() : _root(0), _priorities(), _index(), _index_stale(false) {}
 
-    // Copy constructor
-    Treap(const Treap& other) : _root(0) {
+    // Copy constructor (the copy gets its own priority stream)
+    Treap(const Treap& other)
+        : _root(0), _priorities(other._priorities), _index(),
+          _index_stale(false) {
         _root = clone_subtree(other._root, 0);
+        reindex();
     }
 
     // Destructor
@@ -230,11 +960,13 @@ template <typename K, typename V> class Treap {
         clear();
     }
 
-    // Assignment operator
+    // Assignment operator (starts a new priority stream, like the copy)
     Treap& operator=(const Treap& other) {
         if (this != &other) {
             clear();
+            _priorities = other._priorities;
             _root = clone_subtree(other._root, 0);
+            reindex();
         }
         return *this;
     }
@@ -244,14 +976,48 @@ template <typename K, typename V> class Treap {
         return get_subtree_size(_root);
     }
 
+    // Root node (NULL if empty), for read-only walks over the augmented
+    // structure such as IntervalTreap's queries.
+    TNode* root() const {
+        return _root;
+    }
+
+    // Bytes used by the find() index (0 without TreapHashIndex, or while
+    // the index is stale).
+    int find_index_bytes() const {
+        return _index.memory_bytes();
+    }
+
+    // Whether find() uses the hash index (false without TreapHashIndex, and
+    // after split or a set operation until rebuild_index()).
+    bool find_index_current() const {
+        return index_type::ENABLED && !_index_stale;
+    }
+
+    /**
+     * @brief Rebuilds the find() index after split or a set operation left
+     * it stale. O(n) if it was stale, O(1) otherwise.
+     */
+    void rebuild_index() {
+        if (_index_stale) {
+            _index.reserve(size());
+            index_subtree(_root);
+            _index_stale = false;
+        }
+    }
+
     // Removes all nodes.
     void clear() {
         destroy_subtree(_root);
         _root = 0;
+        reset_index();
     }
 
     /**
-     * @brief Finds the node with the given key in the treap.
+     * @brief Finds the node with the given key in the treap. With a current
+     * TreapHashIndex this is a hash lookup, O(1) expected; otherwise (or
+     * while split / a set operation has left the index stale) it searches
+     * the tree, expected O(log n).
      *
      * @param key The key to search for in the treap.
      *
@@ -259,6 +1025,9 @@ template <typename K, typename V> class Treap {
      * otherwise, returns NULL.
      */
     TNode* find(const K& key) const {
+        if (index_type::ENABLED && !_index_stale) {
+            return _index.find(key);
+        }
         TNode* curr_node = _root;
         while (curr_node != 0) {
             if (key < curr_node->key) {
@@ -322,6 +1091,76 @@ template <typename K, typename V> class Treap {
         return best_node;
     }
 
+    /**
+     * @brief Finds the node with the given key, starting the search from a
+     * nearby node (finger search). Expected O(log d) for a key d positions
+     * away from finger.
+     *
+     * @param finger Node of this treap to start from, e.g. the cursor (NULL
+     * searches from the root).
+     * @param key The key to search for.
+     *
+     * @return Pointer to the node with the given key, or NULL if not found.
+     */
+    TNode* find_from(TNode* finger, const K& key) const {
+        TNode* found = finger_bound(finger, key, false);
+        if (found != 0 && !(key < found->key)) {
+            return found;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief lower_bound() starting from a nearby node (finger search).
+     * Expected O(log d) for a result d positions away from finger.
+     *
+     * @param finger Node of this treap to start from (NULL: the root).
+     * @param key The key to compare against.
+     *
+     * @return The first node with key >= key, or NULL if none exists.
+     */
+    TNode* lower_bound_from(TNode* finger, const K& key) const {
+        return finger_bound(finger, key, false);
+    }
+
+    /**
+     * @brief upper_bound() starting from a nearby node (finger search).
+     * Expected O(log d) for a result d positions away from finger.
+     *
+     * @param finger Node of this treap to start from (NULL: the root).
+     * @param key The key to compare against.
+     *
+     * @return The first node with key > key, or NULL if none exists.
+     */
+    TNode* upper_bound_from(TNode* finger, const K& key) const {
+        return finger_bound(finger, key, true);
+    }
+
+    /**
+     * @brief find() for n keys at once, with the descents interleaved and
+     * prefetched so that their cache misses overlap. Same results as calling
+     * find() per key; faster on large treaps that do not fit in cache.
+     *
+     * @param keys The keys to search for.
+     * @param n Number of keys.
+     * @param out Receives, per key, its node or NULL.
+     */
+    void find_batch(const K* keys, int n, TNode** out) const {
+        bound_batch(keys, n, out, true);
+    }
+
+    /**
+     * @brief lower_bound() for n keys at once, interleaved and prefetched
+     * like find_batch().
+     *
+     * @param keys The keys to compare against.
+     * @param n Number of keys.
+     * @param out Receives, per key, the first node with key >= it, or NULL.
+     */
+    void lower_bound_batch(const K* keys, int n, TNode** out) const {
+        bound_batch(keys, n, out, false);
+    }
+
     /**
      * @brief Inserts a new node with the given key and value into the treap.
      *
@@ -333,6 +1172,12 @@ template <typename K, typename V> class Treap {
      * with the same key without modifying the treap.
      */
     TNode* insert(const K& key, const V& value) {
+        if (index_type::ENABLED && !_index_stale) {
+            TNode* existing = _index.find(key);
+            if (existing != 0) {
+                return existing;
+            }
+        }
         TNode* parent = 0;
         TNode* curr_node = _root;
         while (curr_node != 0) {
@@ -349,6 +1194,9 @@ template <typename K, typename V> class Treap {
         // Create the new node with a random priority and link it to the parent.
         TNode* new_node = new TNode(key, value, next_priority());
         new_node->parent = parent;
+        if (!_index_stale) {
+            _index.insert(new_node);
+        }
 
         // Link new node to parent.
         if (parent == 0) {
@@ -359,8 +1207,8 @@ template <typename K, typename V> class Treap {
             parent->right = new_node;
         }
 
-        // Fix subtree sizes up from the parent.
-        pull_up(parent);
+        // Fix subtree sizes up from the new node.
+        pull_up(new_node);
 
         // Restore heap property by rotating the new node up until it's in the
         // correct position.
@@ -404,6 +1252,9 @@ template <typename K, typename V> class Treap {
         }
 
         // Detach the leaf node from its parent and delete it.
+        if (!_index_stale) {
+            _index.erase(node->key);
+        }
         TNode* parent = node->parent;
         if (parent == 0) {
             _root = 0;
@@ -417,6 +1268,140 @@ template <typename K, typename V> class Treap {
         pull_up(parent);
     }
 
+    /**
+     * @brief Moves every node with key >= key into right, keeping the nodes
+     * with smaller keys in this treap. Whatever right held before is freed.
+     *
+     * Nodes are re-linked, not copied, so cursors stay valid (they now point
+     * into whichever treap holds their key). Expected O(log n).
+     *
+     * @param key The split key.
+     * @param right Receives the nodes with keys >= key.
+     */
+    void split(const K& key, Treap& right) {
+        if (this == &right) {
+            return;
+        }
+        right.clear();
+        TNode* left_root;
+        TNode* right_root;
+        split_nodes(_root, key, left_root, right_root);
+        set_root(left_root);
+        right.set_root(right_root);
+        invalidate_index();
+        right.invalidate_index();
+    }
+
+    /**
+     * @brief Appends every node of right to this treap. All keys in right
+     * must be greater than all keys in this treap. right is left empty.
+     *
+     * Nodes are re-linked, not copied, so cursors stay valid. Expected
+     * O(log n + log m). With TreapHashIndex, when both indexes are current
+     * right's m nodes are added to this one, so the join is O(m) expected.
+     *
+     * @param right The treap to append.
+     */
+    void join(Treap& right) {
+        if (this == &right) {
+            return;
+        }
+        assert(_root == 0 || right._root == 0 ||
+               back()->key < right.front()->key);
+        if (!_index_stale && !right._index_stale) {
+            index_subtree(right._root);
+        } else {
+            invalidate_index();
+        }
+        set_root(join_nodes(_root, right._root));
+        right._root = 0;
+        right.reset_index();
+    }
+
+    /**
+     * @brief Replaces the contents with n key-value pairs given in strictly
+     * increasing key order, in O(n) instead of n inserts.
+     *
+     * Builds the Cartesian tree of the fresh priorities left to right: each
+     * new node climbs the right spine (via parent pointers) past the nodes
+     * with larger priorities and adopts them as its left subtree. Every node
+     * is climbed past at most once.
+     *
+     * @param keys Keys in strictly increasing order.
+     * @param values Values matching keys.
+     * @param n Number of pairs (>= 0).
+     */
+    void build_from_sorted(const K* keys, const V* values, int n) {
+        build_with(keys, values, n, static_cast<TreapSerialPool*>(0));
+    }
+
+    /**
+     * @brief Merges other into this treap; keys present in both keep this
+     * treap's node and value, so cursors into this treap stay valid. other
+     * is left empty. Expected O(m log(n / m + 1)).
+     *
+     * @param other The treap to merge in.
+     */
+    void set_union(Treap& other) {
+        union_with(other, static_cast<TreapSerialPool*>(0));
+    }
+
+    /**
+     * @brief Keeps only the keys that are also in other (with this treap's
+     * nodes and values, so cursors to them stay valid). other is left
+     * empty. Expected O(m log(n / m + 1)).
+     *
+     * @param other The treap to intersect with.
+     */
+    void set_intersection(Treap& other) {
+        intersection_with(other, static_cast<TreapSerialPool*>(0));
+    }
+
+    /**
+     * @brief Removes every key that is in other. other is left empty.
+     * Expected O(m log(n / m + 1)).
+     *
+     * @param other The treap whose keys are removed.
+     */
+    void set_difference(Treap& other) {
+        difference_with(other, static_cast<TreapSerialPool*>(0));
+    }
+
+    /**
+     * @brief Erases every node for which pred(key, value) is false. O(n).
+     *
+     * @param pred Callable as bool pred(const K&, const V&).
+     */
+    template <typename Predicate> void filter(Predicate pred) {
+        filter_with(pred, static_cast<TreapSerialPool*>(0));
+    }
+
+    /**
+     * @brief Erases every node with lo <= key < hi.
+     *
+     * Two splits cut out the range, which is freed, and one join closes the
+     * gap: expected O(log n + k) for k erased nodes.
+     *
+     * @param lo Smallest key to erase.
+     * @param hi First key past the range (not erased).
+     */
+    void erase_range(const K& lo, const K& hi) {
+        if (!(lo < hi)) {
+            return;
+        }
+        TNode* left_root;
+        TNode* rest;
+        split_nodes(_root, lo, left_root, rest);
+        TNode* middle;
+        TNode* right_root;
+        split_nodes(rest, hi, middle, right_root);
+        if (!_index_stale) {
+            unindex_subtree(middle);
+        }
+        destroy_subtree(middle);
+        set_root(join_nodes(left_root, right_root));
+    }
+
     /**
      * @brief Finds the node with the smallest key in the treap.
      *
@@ -584,6 +1569,141 @@ template <typename K, typename V> class Treap {
     TNode* kth_element(int k) const {
         return kth(k);
     }
+
+    /**
+     * @brief Exports the current contents into a read-only EytzingerIndex
+     * for read-mostly phases. The index is a copy: later changes to the
+     * treap do not affect it. O(n).
+     *
+     * @param index Receives the keys and values in key order.
+     */
+    void freeze(EytzingerIndex<K, V>& index) const {
+        int n = size();
+        K* keys = new K[n > 0 ? n : 1];
+        V* values = new V[n > 0 ? n : 1];
+        int i = 0;
+        for (TNode* node = front(); node != 0; node = successor(node)) {
+            keys[i] = node->key;
+            values[i] = node->value;
+            ++i;
+        }
+        index.assign(keys, values, n);
+        delete[] keys;
+        delete[] values;
+    }
+
+    /**
+     * @brief Replaces the value of a node and refreshes the aggregates on
+     * its path to the root. With a Monoid, values must be changed through
+     * this instead of assigning node->value. O(depth).
+     *
+     * @param node Pointer to the node to update (safe on NULL).
+     * @param value The new value.
+     */
+    void set_value(TNode* node, const V& value) {
+        if (node == 0) {
+            return;
+        }
+        node->value = value;
+        pull_up(node);
+    }
+
+    /**
+     * @brief Aggregates the values of the keys in [lo, hi) with the Monoid,
+     * in key order.
+     *
+     * Walks down to the highest node inside the range, then down its left
+     * subtree for the lo boundary and its right subtree for the hi boundary,
+     * taking whole-subtree aggregates on the way. Expected O(log n)
+     * regardless of how many keys are in the range.
+     *
+     * @param lo Smallest key included.
+     * @param hi First key past the range (not included).
+     *
+     * @return The aggregate, or Monoid::identity() for an empty range.
+     */
+    aggregate_type range_query(const K& lo, const K& hi) const {
+        TNode* split_node = _root;
+        while (split_node != 0) {
+            if (split_node->key < lo) {
+                split_node = split_node->right;
+            } else if (!(split_node->key < hi)) {
+                split_node = split_node->left;
+            } else {
+                break;
+            }
+        }
+        if (split_node == 0) {
+            return Monoid::identity();
+        }
+        return Monoid::combine(
+            Monoid::combine(aggregate_from(split_node->left, lo),
+                            Monoid::lift(split_node->value)),
+            aggregate_below(split_node->right, hi));
+    }
+
+    /**
+     * @brief Aggregates the values of all keys < key, in key order. Expected
+     * O(log n).
+     *
+     * @param key First key past the prefix (not included).
+     *
+     * @return The aggregate, or Monoid::identity() if no key is smaller.
+     */
+    aggregate_type prefix_query(const K& key) const {
+        return aggregate_below(_root, key);
+    }
+
+  protected:
+    // The bulk operations on a task pool (NULL runs them on this thread);
+    // ParallelTreap.h calls them with a ForkJoinPool.
+
+    template <typename Pool>
+    void build_with(const K* keys, const V* values, int n, Pool* pool) {
+        clear();
+        unsigned int base = _priorities.take(static_cast<unsigned int>(n));
+        set_root(build_nodes(keys, values, 0, n, &_priorities, base, pool));
+        reindex();
+    }
+
+    template <typename Pool> void union_with(Treap& other, Pool* pool) {
+        if (this == &other) {
+            return;
+        }
+        set_root(union_nodes(_root, other._root, pool));
+        other._root = 0;
+        other.reset_index();
+        invalidate_index();
+    }
+
+    template <typename Pool>
+    void intersection_with(Treap& other, Pool* pool) {
+        if (this == &other) {
+            return;
+        }
+        set_root(intersection_nodes(_root, other._root, pool));
+        other._root = 0;
+        other.reset_index();
+        invalidate_index();
+    }
+
+    template <typename Pool>
+    void difference_with(Treap& other, Pool* pool) {
+        if (this == &other) {
+            clear();
+            return;
+        }
+        set_root(difference_nodes(_root, other._root, pool));
+        other._root = 0;
+        other.reset_index();
+        invalidate_index();
+    }
+
+    template <typename Predicate, typename Pool>
+    void filter_with(Predicate& pred, Pool* pool) {
+        set_root(filter_nodes(_root, pred, pool));
+        reindex();
+    }
 };
 
 #endif // SELF_BALANCING_BST_H
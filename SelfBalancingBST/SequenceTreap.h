@@ -0,0 +1,499 @@
+#ifndef SEQUENCE_TREAP_H
+#define SEQUENCE_TREAP_H
+
+// Implicit-key treap: a sequence with O(log n) positional operations.
+#include "TreapPriority.h"
+#include <cassert>
+
+/**
+ * SequenceTreapNode
+ * A node of a SequenceTreap. Its position is not stored; it is the number of
+ * nodes before it in the in-order walk, derived from subtree_size.
+ *
+ * Tags describe an update that has already been applied to this node's value
+ * and sum but not yet to its children (lazy propagation).
+ */
+template <typename T> struct SequenceTreapNode {
+    T value;
+    T sum; // Sum of the values in this subtree.
+
+    unsigned int priority; // heap key (smaller = higher priority)
+    int subtree_size;      // size of subtree rooted here
+
+    T add_tag;     // Pending add for the children.
+    T assign_tag;  // Pending assign for the children.
+    bool has_add;
+    bool has_assign; // Applied before add_tag when both are set.
+    bool reversed;   // Pending reversal of the children's subtrees.
+
+    SequenceTreapNode* left;
+    SequenceTreapNode* right;
+
+    SequenceTreapNode(const T& v, unsigned int p)
+        : value(v), sum(v), priority(p), subtree_size(1), add_tag(),
+          assign_tag(), has_add(false), has_assign(false), reversed(false),
+          left(0), right(0) {}
+};
+
+/**
+ * SequenceTreap
+ * A sequence of T (like DynamicallySizedArray) stored as a treap ordered by
+ * position instead of by key. Every positional operation splits the tree at
+ * the positions involved and merges it back, so inserting or erasing in the
+ * middle, and reversing, assigning or adding to a range, are expected
+ * O(log n) instead of O(n).
+ *
+ * Ranges are half-open: [first, last). T must support + and multiplication
+ * by T(int) for sums.
+ */
+template <typename T> class SequenceTreap {
+  private:
+    typedef SequenceTreapNode<T> SNode;
+    SNode* _root;
+    TreapPriorities _priorities;
+
+    static int get_subtree_size(SNode* node) {
+        return (node == 0) ? 0 : node->subtree_size;
+    }
+
+    // Recomputes size and sum from the children (whose tags are applied).
+    static void pull(SNode* node) {
+        node->subtree_size =
+            1 + get_subtree_size(node->left) + get_subtree_size(node->right);
+        node->sum = node->value;
+        if (node->left != 0) {
+            node->sum = node->left->sum + node->sum;
+        }
+        if (node->right != 0) {
+            node->sum = node->sum + node->right->sum;
+        }
+    }
+
+    // Tag appliers: update node's value and sum now, remember the tag for
+    // its children.
+    static void apply_assign(SNode* node, const T& value) {
+        if (node == 0) {
+            return;
+        }
+        node->value = value;
+        node->sum = value * T(node->subtree_size);
+        node->assign_tag = value;
+        node->has_assign = true;
+        node->add_tag = T();
+        node->has_add = false;
+    }
+
+    static void apply_add(SNode* node, const T& delta) {
+        if (node == 0) {
+            return;
+        }
+        node->value = node->value + delta;
+        node->sum = node->sum + delta * T(node->subtree_size);
+        if (node->has_assign) {
+            node->assign_tag = node->assign_tag + delta;
+        } else if (node->has_add) {
+            node->add_tag = node->add_tag + delta;
+        } else {
+            node->add_tag = delta;
+            node->has_add = true;
+        }
+    }
+
+    static void apply_reverse(SNode* node) {
+        if (node == 0) {
+            return;
+        }
+        SNode* temp = node->left;
+        node->left = node->right;
+        node->right = temp;
+        node->reversed = !node->reversed;
+    }
+
+    /**
+     * @brief Hands node's pending tags down to its children. Called before
+     * looking at or re-linking the children.
+     *
+     * @param node The node whose tags to push down.
+     */
+    static void push(SNode* node) {
+        if (node->has_assign) {
+            apply_assign(node->left, node->assign_tag);
+            apply_assign(node->right, node->assign_tag);
+            node->has_assign = false;
+        }
+        if (node->has_add) {
+            apply_add(node->left, node->add_tag);
+            apply_add(node->right, node->add_tag);
+            node->add_tag = T();
+            node->has_add = false;
+        }
+        if (node->reversed) {
+            apply_reverse(node->left);
+            apply_reverse(node->right);
+            node->reversed = false;
+        }
+    }
+
+    /**
+     * @brief Splits a subtree into its first count nodes and the rest.
+     *
+     * @param tree_node Root of the subtree (may be NULL).
+     * @param count Number of nodes that go to left_root.
+     * @param left_root Receives the first count nodes.
+     * @param right_root Receives the remaining nodes.
+     */
+    static void split_nodes(SNode* tree_node, int count, SNode*& left_root,
+                            SNode*& right_root) {
+        if (tree_node == 0) {
+            left_root = 0;
+            right_root = 0;
+            return;
+        }
+        push(tree_node);
+        int left_size = get_subtree_size(tree_node->left);
+        if (left_size < count) {
+            split_nodes(tree_node->right, count - left_size - 1,
+                        tree_node->right, right_root);
+            pull(tree_node);
+            left_root = tree_node;
+        } else {
+            split_nodes(tree_node->left, count, left_root, tree_node->left);
+            pull(tree_node);
+            right_root = tree_node;
+        }
+    }
+
+    /**
+     * @brief Concatenates two subtrees, keeping the heap order on
+     * priorities.
+     *
+     * @return Root of the concatenation.
+     */
+    static SNode* merge_nodes(SNode* left_root, SNode* right_root) {
+        if (left_root == 0) {
+            return right_root;
+        }
+        if (right_root == 0) {
+            return left_root;
+        }
+        if (left_root->priority < right_root->priority) {
+            push(left_root);
+            left_root->right = merge_nodes(left_root->right, right_root);
+            pull(left_root);
+            return left_root;
+        }
+        push(right_root);
+        right_root->left = merge_nodes(left_root, right_root->left);
+        pull(right_root);
+        return right_root;
+    }
+
+    static void destroy_subtree(SNode* node) {
+        if (node == 0) {
+            return;
+        }
+        destroy_subtree(node->left);
+        destroy_subtree(node->right);
+        delete node;
+    }
+
+    // Deep copy (tags are copied as they are).
+    static SNode* clone_subtree(SNode* source_node) {
+        if (source_node == 0) {
+            return 0;
+        }
+        SNode* new_node = new SNode(*source_node);
+        new_node->left = clone_subtree(source_node->left);
+        new_node->right = clone_subtree(source_node->right);
+        return new_node;
+    }
+
+    static void pull_subtree(SNode* node) {
+        if (node == 0) {
+            return;
+        }
+        pull_subtree(node->left);
+        pull_subtree(node->right);
+        pull(node);
+    }
+
+    // Writes the subtree's values in order to out; returns the next slot.
+    static T* write_subtree(SNode* node, T* out) {
+        if (node == 0) {
+            return out;
+        }
+        push(node);
+        out = write_subtree(node->left, out);
+        *out++ = node->value;
+        return write_subtree(node->right, out);
+    }
+
+    /**
+     * @brief Cuts [first, last) out of the tree: on return _root holds it and
+     * before/after hold the rest, to be put back with restore().
+     */
+    void cut(int first, int last, SNode*& before, SNode*& after) {
+        assert(0 <= first && first <= last && last <= size());
+        SNode* rest;
+        split_nodes(_root, first, before, rest);
+        split_nodes(rest, last - first, _root, after);
+    }
+
+    void restore(SNode* before, SNode* after) {
+        _root = merge_nodes(merge_nodes(before, _root), after);
+    }
+
+    // Node at position pos, with the tags on its path pushed down.
+    SNode* node_at(int pos) {
+        assert(0 <= pos && pos < size());
+        SNode* current = _root;
+        while (true) {
+            push(current);
+            int left_size = get_subtree_size(current->left);
+            if (pos < left_size) {
+                current = current->left;
+            } else if (pos == left_size) {
+                return current;
+            } else {
+                pos -= left_size + 1;
+                current = current->right;
+            }
+        }
+    }
+
+    // Recomputes sums on the path to position pos after its value changed.
+    static void pull_path(SNode* node, int pos) {
+        int left_size = get_subtree_size(node->left);
+        if (pos < left_size) {
+            pull_path(node->left, pos);
+        } else if (pos > left_size) {
+            pull_path(node->right, pos - left_size - 1);
+        }
+        pull(node);
+    }
+
+  public:
+    // Constructor
+    SequenceTreap() : _root(0), _priorities() {}
+
+    /**
+     * @brief Builds the sequence first[0..n) in O(n).
+     *
+     * The Cartesian tree of fresh priorities is built left to right with a
+     * stack holding the right spine; each element pops the spine nodes with
+     * larger priorities and adopts them as its left subtree.
+     *
+     * @param first Pointer to the first value.
+     * @param n Number of values (>= 0).
+     */
+    SequenceTreap(const T* first, int n) : _root(0), _priorities() {
+        assert(n >= 0);
+        if (n == 0) {
+            return;
+        }
+        SNode** spine = new SNode*[n];
+        int depth = 0;
+        for (int i = 0; i < n; ++i) {
+            SNode* node = new SNode(first[i], _priorities.next());
+            SNode* adopted = 0;
+            while (depth > 0 && node->priority < spine[depth - 1]->priority) {
+                adopted = spine[--depth];
+            }
+            node->left = adopted;
+            if (depth > 0) {
+                spine[depth - 1]->right = node;
+            }
+            spine[depth++] = node;
+        }
+        _root = spine[0];
+        delete[] spine;
+        pull_subtree(_root);
+    }
+
+    // Copy Constructor
+    SequenceTreap(const SequenceTreap& other)
+        : _root(clone_subtree(other._root)), _priorities() {}
+
+    // Assignment operator
+    SequenceTreap& operator=(const SequenceTreap& other) {
+        if (this != &other) {
+            clear();
+            _root = clone_subtree(other._root);
+            _priorities = other._priorities;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~SequenceTreap() {
+        clear();
+    }
+
+    // Number of elements.
+    int size() const {
+        return get_subtree_size(_root);
+    }
+
+    // Removes all elements.
+    void clear() {
+        destroy_subtree(_root);
+        _root = 0;
+    }
+
+    /**
+     * @brief Provides the element at a position. Expected O(log n).
+     *
+     * @param pos Position (0 <= pos < size()).
+     *
+     * @return The element at pos.
+     */
+    T get(int pos) {
+        return node_at(pos)->value;
+    }
+
+    /**
+     * @brief Replaces the element at a position. Expected O(log n).
+     *
+     * @param pos Position (0 <= pos < size()).
+     * @param value The new value.
+     */
+    void set(int pos, const T& value) {
+        node_at(pos)->value = value;
+        pull_path(_root, pos);
+    }
+
+    /**
+     * @brief Inserts value so that it ends up at position pos. Expected
+     * O(log n).
+     *
+     * @param pos Position (0 <= pos <= size()).
+     * @param value The value to insert.
+     */
+    void insert(int pos, const T& value) {
+        assert(0 <= pos && pos <= size());
+        SNode* left_root;
+        SNode* right_root;
+        split_nodes(_root, pos, left_root, right_root);
+        SNode* node = new SNode(value, _priorities.next());
+        _root = merge_nodes(merge_nodes(left_root, node), right_root);
+    }
+
+    // Appends value at the end. Expected O(log n).
+    void push_back(const T& value) {
+        insert(size(), value);
+    }
+
+    /**
+     * @brief Removes the element at a position. Expected O(log n).
+     *
+     * @param pos Position (0 <= pos < size()).
+     */
+    void erase(int pos) {
+        erase_range(pos, pos + 1);
+    }
+
+    /**
+     * @brief Removes the elements in [first, last). Expected O(log n + k)
+     * for k removed elements.
+     */
+    void erase_range(int first, int last) {
+        SNode* before;
+        SNode* after;
+        cut(first, last, before, after);
+        destroy_subtree(_root);
+        _root = 0;
+        restore(before, after);
+    }
+
+    /**
+     * @brief Reverses the elements in [first, last). Expected O(log n).
+     */
+    void reverse(int first, int last) {
+        SNode* before;
+        SNode* after;
+        cut(first, last, before, after);
+        apply_reverse(_root);
+        restore(before, after);
+    }
+
+    /**
+     * @brief Sets every element in [first, last) to value. Expected
+     * O(log n).
+     */
+    void assign(int first, int last, const T& value) {
+        SNode* before;
+        SNode* after;
+        cut(first, last, before, after);
+        apply_assign(_root, value);
+        restore(before, after);
+    }
+
+    /**
+     * @brief Adds delta to every element in [first, last). Expected
+     * O(log n).
+     */
+    void add(int first, int last, const T& delta) {
+        SNode* before;
+        SNode* after;
+        cut(first, last, before, after);
+        apply_add(_root, delta);
+        restore(before, after);
+    }
+
+    /**
+     * @brief Sums the elements in [first, last). Expected O(log n).
+     *
+     * @return The sum, or T() for an empty range.
+     */
+    T sum(int first, int last) {
+        SNode* before;
+        SNode* after;
+        cut(first, last, before, after);
+        T result = (_root == 0) ? T() : _root->sum;
+        restore(before, after);
+        return result;
+    }
+
+    /**
+     * @brief Moves the elements from position pos on to the front of right
+     * (whose old contents are freed). Expected O(log n).
+     *
+     * @param pos Number of elements that stay (0 <= pos <= size()).
+     * @param right Receives the elements [pos, size()).
+     */
+    void split(int pos, SequenceTreap& right) {
+        assert(0 <= pos && pos <= size());
+        if (this == &right) {
+            return;
+        }
+        right.clear();
+        SNode* left_root;
+        split_nodes(_root, pos, left_root, right._root);
+        _root = left_root;
+    }
+
+    /**
+     * @brief Appends all elements of right to this sequence; right is left
+     * empty. Expected O(log n + log m).
+     *
+     * @param right The sequence to append.
+     */
+    void append(SequenceTreap& right) {
+        if (this == &right) {
+            return;
+        }
+        _root = merge_nodes(_root, right._root);
+        right._root = 0;
+    }
+
+    /**
+     * @brief Copies the sequence into out[0..size()). O(n).
+     *
+     * @param out Destination with room for size() values.
+     */
+    void to_array(T* out) {
+        write_subtree(_root, out);
+    }
+};
+
+#endif // SEQUENCE_TREAP_H
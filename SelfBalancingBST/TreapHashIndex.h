@@ -0,0 +1,197 @@
+#ifndef TREAP_HASH_INDEX_H
+#define TREAP_HASH_INDEX_H
+
+// Optional key -> node hash index for Treap::find.
+#include "DynamicallySizedArray.h"
+#include "HashMix.h"
+
+/**
+ * The fourth Treap template parameter picks the find() index:
+ *  - TreapNoIndex (default): find() searches the tree, nothing is stored,
+ *  - TreapHashIndex: a Robin Hood hash table maps each key to its node, so
+ *    find() is O(1) expected; every other operation still uses the tree.
+ * The index needs a KeyHash<K> specialization (HashMix.h) for the key type.
+ */
+struct TreapNoIndex {};
+struct TreapHashIndex {};
+
+template <typename Index, typename K, typename Node> class TreapKeyIndex;
+
+/**
+ * TreapKeyIndex<TreapNoIndex, ...>
+ * No index: every call is a no-op and Treap::find() walks the tree.
+ */
+template <typename K, typename Node>
+class TreapKeyIndex<TreapNoIndex, K, Node> {
+  public:
+    static const bool ENABLED = false;
+
+    Node* find(const K&) const {
+        return 0;
+    }
+    void reserve(int) {}
+    void insert(Node*) {}
+    void erase(const K&) {}
+    void clear() {}
+    int memory_bytes() const {
+        return 0;
+    }
+};
+
+/**
+ * TreapKeyIndex<TreapHashIndex, ...>
+ * Open-addressing hash table from key to node with Robin Hood probing:
+ *  - each slot keeps a copy of the key, the node and its distance from its
+ *    home slot, so a lookup scans contiguous slots and dereferences only
+ *    the matching node,
+ *  - an insert takes the slot of any entry that is closer to home than
+ *    itself and carries that entry on, which keeps probe lengths short and
+ *    lets a miss stop as soon as it passes a closer entry,
+ *  - erase shifts the following entries back one slot (no tombstones).
+ * The capacity is a power of two, grown at 7/8 load.
+ */
+template <typename K, typename Node>
+class TreapKeyIndex<TreapHashIndex, K, Node> {
+  private:
+    struct Slot {
+        K key;
+        int distance; // From the home slot; -1 when empty.
+        Node* node;
+
+        Slot() : key(), distance(-1), node(0) {}
+    };
+
+    static const int MIN_CAPACITY = 16;
+
+    DynamicallySizedArray<Slot> _slots;
+    int _size;
+    unsigned int _mask; // Capacity - 1 (0 while there are no slots).
+
+    static bool same_key(const K& a, const K& b) {
+        return !(a < b) && !(b < a);
+    }
+
+    // Slot holding key, or -1.
+    int find_slot(const K& key) const {
+        if (_size == 0) {
+            return -1;
+        }
+        unsigned int slot = KeyHash<K>::hash(key) & _mask;
+        for (int distance = 0;; ++distance) {
+            const Slot& current = _slots[slot];
+            if (current.distance < distance) {
+                return -1; // Empty, or an entry closer to home: not present.
+            }
+            if (current.distance == distance && same_key(current.key, key)) {
+                return static_cast<int>(slot);
+            }
+            slot = (slot + 1) & _mask;
+        }
+    }
+
+    // Robin Hood insertion of an entry known to be absent, without growing.
+    void place(Slot entry) {
+        unsigned int slot = KeyHash<K>::hash(entry.key) & _mask;
+        entry.distance = 0;
+        for (;;) {
+            Slot& current = _slots[slot];
+            if (current.distance < 0) {
+                current = entry;
+                return;
+            }
+            if (current.distance < entry.distance) {
+                Slot displaced = current;
+                current = entry;
+                entry = displaced;
+            }
+            slot = (slot + 1) & _mask;
+            ++entry.distance;
+        }
+    }
+
+    void rehash(int capacity) {
+        DynamicallySizedArray<Slot> old_slots(_slots);
+        _slots.resize(0);
+        _slots.resize(capacity); // All empty.
+        _mask = static_cast<unsigned int>(capacity - 1);
+        for (int i = 0; i < old_slots.size(); ++i) {
+            if (old_slots[i].distance >= 0) {
+                place(old_slots[i]);
+            }
+        }
+    }
+
+  public:
+    static const bool ENABLED = true;
+
+    TreapKeyIndex() : _slots(), _size(0), _mask(0) {}
+
+    /**
+     * @brief The node with the given key. O(1) expected.
+     *
+     * @return The node, or NULL if the key is not indexed.
+     */
+    Node* find(const K& key) const {
+        int slot = find_slot(key);
+        return (slot < 0) ? 0 : _slots[slot].node;
+    }
+
+    // Grows the table to hold n entries without further rehashing.
+    void reserve(int n) {
+        int capacity = (_slots.size() < MIN_CAPACITY) ? MIN_CAPACITY
+                                                      : _slots.size();
+        while (8 * n > 7 * capacity) {
+            capacity *= 2;
+        }
+        if (capacity != _slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    // Indexes node under its key (which must not be indexed yet).
+    void insert(Node* node) {
+        int capacity = _slots.size();
+        if (8 * (_size + 1) > 7 * capacity) {
+            rehash(capacity < MIN_CAPACITY ? MIN_CAPACITY : 2 * capacity);
+        }
+        Slot entry;
+        entry.key = node->key;
+        entry.node = node;
+        place(entry);
+        ++_size;
+    }
+
+    // Removes key from the index (if present), shifting later entries back.
+    void erase(const K& key) {
+        int found = find_slot(key);
+        if (found < 0) {
+            return;
+        }
+        unsigned int slot = static_cast<unsigned int>(found);
+        for (;;) {
+            unsigned int next = (slot + 1) & _mask;
+            if (_slots[next].distance <= 0) {
+                _slots[slot] = Slot();
+                break;
+            }
+            _slots[slot] = _slots[next];
+            --_slots[slot].distance;
+            slot = next;
+        }
+        --_size;
+    }
+
+    // Removes every entry and releases the table.
+    void clear() {
+        _slots = DynamicallySizedArray<Slot>();
+        _size = 0;
+        _mask = 0;
+    }
+
+    // Bytes used by the table.
+    int memory_bytes() const {
+        return _slots.capacity() * static_cast<int>(sizeof(Slot));
+    }
+};
+
+#endif // TREAP_HASH_INDEX_H
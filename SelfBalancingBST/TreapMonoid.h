@@ -0,0 +1,106 @@
+#ifndef TREAP_MONOID_H
+#define TREAP_MONOID_H
+
+// Monoid augmentations for Treap: per-subtree aggregates of the values.
+#include <limits>
+
+/**
+ * A Treap monoid is a type with static members
+ *  - typedef ... value_type;               the aggregate type
+ *  - static value_type identity();          aggregate of no values
+ *  - static value_type lift(V const& v);    aggregate of one value
+ *  - static value_type combine(a, b);       aggregate of a's values followed
+ *                                           by b's (associative)
+ * Every node keeps the aggregate of its subtree in key order, maintained by
+ * the same pull() that maintains subtree_size.
+ */
+
+/**
+ * TreapNoAggregate
+ * The default: no aggregate is stored (the node's aggregate slot is an empty
+ * base class) and pull() only maintains subtree_size.
+ */
+struct TreapNoAggregate {
+    typedef TreapNoAggregate value_type;
+};
+
+// Sum of the values (identity V()).
+template <typename V> struct TreapSum {
+    typedef V value_type;
+
+    static V identity() {
+        return V();
+    }
+    static V lift(V const& value) {
+        return value;
+    }
+    static V combine(V const& a, V const& b) {
+        return a + b;
+    }
+};
+
+// Minimum of the values (identity: the largest V).
+template <typename V> struct TreapMin {
+    typedef V value_type;
+
+    static V identity() {
+        return std::numeric_limits<V>::max();
+    }
+    static V lift(V const& value) {
+        return value;
+    }
+    static V combine(V const& a, V const& b) {
+        return (b < a) ? b : a;
+    }
+};
+
+// Maximum of the values (identity: the smallest V).
+template <typename V> struct TreapMax {
+    typedef V value_type;
+
+    static V identity() {
+        return std::numeric_limits<V>::is_integer
+                   ? std::numeric_limits<V>::min()
+                   : -std::numeric_limits<V>::max();
+    }
+    static V lift(V const& value) {
+        return value;
+    }
+    static V combine(V const& a, V const& b) {
+        return (a < b) ? b : a;
+    }
+};
+
+// Storage for a node's subtree aggregate.
+template <typename A> struct TreapAggregateField {
+    A aggregate; // Aggregate of the values in this subtree, in key order.
+
+    TreapAggregateField() : aggregate() {}
+};
+
+// No storage at all for TreapNoAggregate (empty base optimization).
+template <> struct TreapAggregateField<TreapNoAggregate> {};
+
+/**
+ * TreapAggregator
+ * Recomputes a node's aggregate from its value and its children's
+ * aggregates; a no-op for TreapNoAggregate.
+ */
+template <typename Monoid> struct TreapAggregator {
+    template <typename Node> static void pull(Node* node) {
+        typename Monoid::value_type result = Monoid::lift(node->value);
+        if (node->left != 0) {
+            result = Monoid::combine(node->left->aggregate, result);
+        }
+        if (node->right != 0) {
+            result = Monoid::combine(result, node->right->aggregate);
+        }
+        node->aggregate = result;
+    }
+};
+
+template <> struct TreapAggregator<TreapNoAggregate> {
+    template <typename Node> static void pull(Node*) {}
+};
+
+#endif // TREAP_MONOID_H
@@ -0,0 +1,82 @@
+#ifndef TREAP_PRIORITY_H
+#define TREAP_PRIORITY_H
+
+// Per-tree priority streams for the treaps.
+#include "HashMix.h"
+
+/**
+ * @brief A seed for a new priority stream. Every call hashes a different
+ * value of a global counter (incremented atomically under GCC/Clang), so
+ * trees built independently get unrelated seeds.
+ *
+ * @return The seed.
+ */
+inline unsigned int treap_new_seed() {
+    static unsigned int seeds_handed_out = 0;
+#if defined(__GNUC__)
+    unsigned int n = __sync_fetch_and_add(&seeds_handed_out, 1u);
+#else
+    unsigned int n = seeds_handed_out++;
+#endif
+    return hash_mix32(n + 2463534242u);
+}
+
+/**
+ * TreapPriorities
+ * The priorities of one tree: the n-th node it creates gets
+ * hash_mix32(hash_mix32(n) ^ seed). A priority depends only on the tree's
+ * seed and the node's creation number, so trees on different threads do not
+ * race, and a bulk build can compute any node's priority independently.
+ *
+ * Equal priorities in two trees would make a join or union of them stack
+ * the tied roots into a chain. The seed is mixed in after the creation
+ * number is hashed, so the streams of two seeds are unrelated rather than
+ * shifted copies of one sequence: a priority shared by two trees is a chance
+ * 32-bit collision, as rare as one inside a single tree. A new tree, a copy
+ * and an assignment target all start a fresh stream. Copied nodes keep
+ * their priorities.
+ */
+class TreapPriorities {
+  private:
+    unsigned int _seed;
+    unsigned int _counter; // Creation number of the next node.
+
+  public:
+    // Constructor: a fresh stream.
+    TreapPriorities() : _seed(treap_new_seed()), _counter(0) {}
+
+    // Copy constructor: a fresh stream, not a copy of other's.
+    TreapPriorities(const TreapPriorities&)
+        : _seed(treap_new_seed()), _counter(0) {}
+
+    // Assignment operator: starts a fresh stream.
+    TreapPriorities& operator=(const TreapPriorities&) {
+        _seed = treap_new_seed();
+        _counter = 0;
+        return *this;
+    }
+
+    // The priority of the n-th node of this stream.
+    unsigned int of(unsigned int n) const {
+        return hash_mix32(hash_mix32(n) ^ _seed);
+    }
+
+    // The priority of the next node.
+    unsigned int next() {
+        return of(_counter++);
+    }
+
+    /**
+     * @brief Takes n consecutive creation numbers at once, for a bulk build
+     * that assigns of(first + i) to its i-th node.
+     *
+     * @return The first of the numbers.
+     */
+    unsigned int take(unsigned int n) {
+        unsigned int first = _counter;
+        _counter += n;
+        return first;
+    }
+};
+
+#endif // TREAP_PRIORITY_H
@@ -0,0 +1,102 @@
+// bench_batch.cpp
+// Benchmark: Treap find / lower_bound one key at a time vs. the batched,
+// prefetch-interleaved find_batch / lower_bound_batch.
+//
+// The treap is filled by inserting N random keys from [0, 2N) in random order
+// (duplicates are skipped), so the nodes of a search path are scattered in
+// memory. QUERIES random keys from the same range (about 40% present) are then
+// looked up in batches of BATCH.
+//
+// Usage: ./bin/bench_batch [N ...]   (default: 1000000 4000000)
+
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+static const int BATCH = 256;
+
+typedef TreapNode<int, int> Node;
+
+static long checksum(Node* const* found, int n) {
+    long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += (found[i] == 0) ? -1 : found[i]->value;
+    }
+    return sum;
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    Treap<int, int> tree;
+    for (int i = 0; i < n; ++i) {
+        tree.insert(static_cast<int>(rng.next() % key_range), i);
+    }
+
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+    Node** found = new Node*[QUERIES];
+
+    clock_t start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        found[i] = tree.find(queries[i]);
+    }
+    double t_find = seconds_since(start);
+    long sum_find = checksum(found, QUERIES);
+
+    start = clock();
+    for (int i = 0; i < QUERIES; i += BATCH) {
+        int count = (QUERIES - i < BATCH) ? QUERIES - i : BATCH;
+        tree.find_batch(queries + i, count, found + i);
+    }
+    double t_find_batch = seconds_since(start);
+    long sum_find_batch = checksum(found, QUERIES);
+
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        found[i] = tree.lower_bound(queries[i]);
+    }
+    double t_lower = seconds_since(start);
+    long sum_lower = checksum(found, QUERIES);
+
+    start = clock();
+    for (int i = 0; i < QUERIES; i += BATCH) {
+        int count = (QUERIES - i < BATCH) ? QUERIES - i : BATCH;
+        tree.lower_bound_batch(queries + i, count, found + i);
+    }
+    double t_lower_batch = seconds_since(start);
+    long sum_lower_batch = checksum(found, QUERIES);
+
+    if (sum_find != sum_find_batch || sum_lower != sum_lower_batch) {
+        std::printf("checksum mismatch for N = %d\n", n);
+    }
+    std::printf("N = %d (%d nodes)\n", n, tree.size());
+    std::printf("  find         %7.2f Mlookups/s   find_batch        %7.2f "
+                "Mlookups/s   speedup %.2fx\n",
+                QUERIES / t_find / 1e6, QUERIES / t_find_batch / 1e6,
+                t_find / t_find_batch);
+    std::printf("  lower_bound  %7.2f Mlookups/s   lower_bound_batch %7.2f "
+                "Mlookups/s   speedup %.2fx\n",
+                QUERIES / t_lower / 1e6, QUERIES / t_lower_batch / 1e6,
+                t_lower / t_lower_batch);
+
+    delete[] queries;
+    delete[] found;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+        bench(4000000);
+    }
+    return 0;
+}
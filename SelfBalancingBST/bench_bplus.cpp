@@ -0,0 +1,150 @@
+// bench_bplus.cpp
+// Benchmark: Treap vs. BPlusTree on the same operation mix.
+//
+// Both maps get N random keys from [0, 2N) inserted in random order, then
+// QUERIES random keys (or ranks) are run through lower_bound, find + rank and
+// kth, the whole map is walked with successor, and every other key is erased.
+//
+// Usage: ./bin/bench_bplus [N ...]   (default: 1000000)
+
+#include "BPlusTree.h"
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+
+typedef TreapNode<int, int> Node;
+typedef BPlusTree<int, int>::cursor Cursor;
+
+static void report(char const* name, int ops, double t_treap, double t_bplus,
+                   long sum_treap, long sum_bplus) {
+    if (sum_treap != sum_bplus) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    std::printf("  %-12s treap %7.2f Mop/s   bplus %8.2f Mop/s   speedup "
+                "%.2fx\n",
+                name, ops / t_treap / 1e6, ops / t_bplus / 1e6,
+                t_treap / t_bplus);
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    int* keys = new int[n];
+    for (int i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(rng.next() % key_range);
+    }
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+
+    // insert
+    Treap<int, int> treap;
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        treap.insert(keys[i], i);
+    }
+    double t_treap = seconds_since(start);
+    BPlusTree<int, int> bplus;
+    start = clock();
+    for (int i = 0; i < n; ++i) {
+        bplus.insert(keys[i], i);
+    }
+    std::printf("N = %d (%d keys)\n", n, treap.size());
+    report("insert", n, t_treap, seconds_since(start), treap.size(),
+           bplus.size());
+
+    // lower_bound
+    long sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = treap.lower_bound(queries[i]);
+        sum_treap += (found == 0) ? -1 : found->value;
+    }
+    t_treap = seconds_since(start);
+    long sum_bplus = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Cursor found = bplus.lower_bound(queries[i]);
+        sum_bplus += found.is_set() ? found.value() : -1;
+    }
+    report("lower_bound", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_bplus);
+
+    // find + rank
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += treap.rank(treap.find(queries[i]));
+    }
+    t_treap = seconds_since(start);
+    sum_bplus = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_bplus += bplus.rank(bplus.find(queries[i]));
+    }
+    report("find + rank", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_bplus);
+
+    // kth
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += treap.kth(queries[i] % treap.size())->value;
+    }
+    t_treap = seconds_since(start);
+    sum_bplus = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_bplus += bplus.kth(queries[i] % bplus.size()).value();
+    }
+    report("kth", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_bplus);
+
+    // in-order walk
+    sum_treap = 0;
+    start = clock();
+    for (Node* node = treap.front(); node != 0;
+         node = treap.successor(node)) {
+        sum_treap += node->value;
+    }
+    t_treap = seconds_since(start);
+    sum_bplus = 0;
+    start = clock();
+    for (Cursor c = bplus.front(); c.is_set(); c = bplus.successor(c)) {
+        sum_bplus += c.value();
+    }
+    report("successor", treap.size(), t_treap, seconds_since(start),
+           sum_treap, sum_bplus);
+
+    // erase every other key
+    start = clock();
+    for (int i = 0; i < n; i += 2) {
+        treap.erase(treap.find(keys[i]));
+    }
+    t_treap = seconds_since(start);
+    start = clock();
+    for (int i = 0; i < n; i += 2) {
+        bplus.erase(bplus.find(keys[i]));
+    }
+    report("find + erase", (n + 1) / 2, t_treap, seconds_since(start),
+           treap.size(), bplus.size());
+
+    delete[] keys;
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// bench_concurrent.cpp
+// Benchmark: reader throughput on ConcurrentTreap vs. Treap behind a
+// pthread reader-writer lock, with one writer updating the map meanwhile.
+//
+// The map starts with N random keys from [0, 2N). For each reader count,
+// the readers run random find calls for SECONDS seconds while the writer
+// alternates inserting and erasing random keys.
+//
+// Usage: ./bin/bench_concurrent [N [readers ...]]   (default: 1000000 1 2 4)
+
+#include "BenchUtil.h"
+#include "ConcurrentTreap.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+static const double SECONDS = 1.0;
+
+// Shared state of one run; exactly one of the two maps is used.
+struct Run {
+    ConcurrentTreap<int, int>* concurrent;
+    Treap<int, int>* locked;
+    pthread_rwlock_t lock;
+    int key_range;
+    int stop;
+    long reads;
+    long writes;
+};
+
+struct ReaderArgs {
+    Run* run;
+    unsigned int seed;
+};
+
+static void* reader_main(void* argument) {
+    ReaderArgs* args = static_cast<ReaderArgs*>(argument);
+    Run* run = args->run;
+    XorShift32 rng(args->seed);
+    long reads = 0;
+    if (run->concurrent != 0) {
+        ConcurrentTreapReader<int, int> reader(*run->concurrent);
+        while (!__atomic_load_n(&run->stop, __ATOMIC_RELAXED)) {
+            int value;
+            reader.find(rng.next() % run->key_range, value);
+            ++reads;
+        }
+    } else {
+        while (!__atomic_load_n(&run->stop, __ATOMIC_RELAXED)) {
+            pthread_rwlock_rdlock(&run->lock);
+            run->locked->find(rng.next() % run->key_range);
+            pthread_rwlock_unlock(&run->lock);
+            ++reads;
+        }
+    }
+    __atomic_fetch_add(&run->reads, reads, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static void* writer_main(void* argument) {
+    Run* run = static_cast<Run*>(argument);
+    XorShift32 rng(12345u);
+    long writes = 0;
+    while (!__atomic_load_n(&run->stop, __ATOMIC_RELAXED)) {
+        int key = static_cast<int>(rng.next() % run->key_range);
+        if (run->concurrent != 0) {
+            if (!run->concurrent->insert(key, key)) {
+                run->concurrent->erase(key);
+            }
+        } else {
+            pthread_rwlock_wrlock(&run->lock);
+            TreapNode<int, int>* node = run->locked->find(key);
+            if (node == 0) {
+                run->locked->insert(key, key);
+            } else {
+                run->locked->erase(node);
+            }
+            pthread_rwlock_unlock(&run->lock);
+        }
+        ++writes;
+    }
+    run->writes = writes;
+    return 0;
+}
+
+// Runs the readers and the writer for SECONDS; returns reads per second.
+static double measure(Run& run, int readers, double& writes_per_second) {
+    run.stop = 0;
+    run.reads = 0;
+    pthread_t* threads = new pthread_t[readers];
+    ReaderArgs* args = new ReaderArgs[readers];
+    pthread_t writer;
+    double start = wall_seconds();
+    for (int i = 0; i < readers; ++i) {
+        args[i].run = &run;
+        args[i].seed = 2463534242u + 7919u * i;
+        pthread_create(&threads[i], 0, reader_main, &args[i]);
+    }
+    pthread_create(&writer, 0, writer_main, &run);
+    while (wall_seconds() - start < SECONDS) {
+        usleep(10000);
+    }
+    __atomic_store_n(&run.stop, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < readers; ++i) {
+        pthread_join(threads[i], 0);
+    }
+    pthread_join(writer, 0);
+    double elapsed = wall_seconds() - start;
+    delete[] threads;
+    delete[] args;
+    writes_per_second = run.writes / elapsed;
+    return run.reads / elapsed;
+}
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    int default_readers[] = {1, 2, 4};
+    int reader_counts = (argc > 2) ? argc - 2 : 3;
+
+    ConcurrentTreap<int, int> concurrent;
+    Treap<int, int> locked;
+    XorShift32 rng(2463534242u);
+    for (int i = 0; i < n; ++i) {
+        int key = static_cast<int>(rng.next() % (2u * n));
+        concurrent.insert(key, key);
+        locked.insert(key, key);
+    }
+    std::printf("N = %d (%d keys), %.1f s per run, 1 writer\n", n,
+                locked.size(), SECONDS);
+
+    for (int i = 0; i < reader_counts; ++i) {
+        int readers = (argc > 2) ? std::atoi(argv[2 + i]) : default_readers[i];
+        Run run;
+        run.key_range = 2 * n;
+        pthread_rwlock_init(&run.lock, 0);
+
+        run.concurrent = 0;
+        run.locked = &locked;
+        double w_locked;
+        double r_locked = measure(run, readers, w_locked);
+
+        run.concurrent = &concurrent;
+        run.locked = 0;
+        double w_concurrent;
+        double r_concurrent = measure(run, readers, w_concurrent);
+        pthread_rwlock_destroy(&run.lock);
+
+        std::printf("  %2d readers  rwlock %7.2f Mreads/s %6.2f Mwrites/s   "
+                    "concurrent %7.2f Mreads/s %6.2f Mwrites/s\n",
+                    readers, r_locked / 1e6, w_locked / 1e6,
+                    r_concurrent / 1e6, w_concurrent / 1e6);
+    }
+    return 0;
+}
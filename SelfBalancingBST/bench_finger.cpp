@@ -0,0 +1,100 @@
+// bench_finger.cpp
+// Benchmark: Treap lower_bound from the root vs. finger search from the
+// previous result (lower_bound_from), on a treap of N even keys 0..2N-2.
+//
+// Query patterns (QUERIES lookups each):
+//  - sequential:   keys increasing by 2, i.e. always the next node,
+//  - local d:      previous key plus a random offset in [-d, d],
+//  - uniform:      uniformly random keys (finger search should not help).
+//
+// Usage: ./bin/bench_finger [N]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+
+// Fills queries with the given pattern; spread 0 means sequential, -1
+// uniform, otherwise the local offset range.
+static void make_queries(int* queries, int n, int spread) {
+    XorShift32 rng(2463534242u);
+    int max_key = 2 * n - 2;
+    int key = 0;
+    for (int i = 0; i < QUERIES; ++i) {
+        if (spread == 0) {
+            key = (2 * i) % (max_key + 1);
+        } else if (spread < 0) {
+            key = static_cast<int>(rng.next() % (max_key + 1));
+        } else {
+            key += static_cast<int>(rng.next() % (2 * spread + 1)) - spread;
+            if (key < 0) {
+                key = -key;
+            }
+            if (key > max_key) {
+                key = 2 * max_key - key;
+            }
+        }
+        queries[i] = key;
+    }
+}
+
+static void bench(Treap<int, int> const& tree, char const* name, int n,
+                  int spread) {
+    int* queries = new int[QUERIES];
+    make_queries(queries, n, spread);
+
+    long checksum_root = 0;
+    clock_t start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        TreapNode<int, int>* found = tree.lower_bound(queries[i]);
+        checksum_root += (found == 0) ? -1 : found->value;
+    }
+    double t_root = seconds_since(start);
+
+    long checksum_finger = 0;
+    TreapNode<int, int>* cursor = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        TreapNode<int, int>* found = tree.lower_bound_from(cursor, queries[i]);
+        checksum_finger += (found == 0) ? -1 : found->value;
+        if (found != 0) {
+            cursor = found;
+        }
+    }
+    double t_finger = seconds_since(start);
+
+    if (checksum_root != checksum_finger) {
+        std::printf("checksum mismatch for %s\n", name);
+    }
+    std::printf("%-13s root %7.2f Mlookups/s   finger %7.2f Mlookups/s   "
+                "speedup %.2fx\n",
+                name, QUERIES / t_root / 1e6, QUERIES / t_finger / 1e6,
+                t_root / t_finger);
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    int* keys = new int[n];
+    int* values = new int[n];
+    for (int i = 0; i < n; ++i) {
+        keys[i] = 2 * i;
+        values[i] = i;
+    }
+    Treap<int, int> tree;
+    tree.build_from_sorted(keys, values, n);
+    delete[] keys;
+    delete[] values;
+
+    std::printf("N = %d, %d queries per pattern\n", n, QUERIES);
+    bench(tree, "sequential", n, 0);
+    bench(tree, "local 16", n, 16);
+    bench(tree, "local 1024", n, 1024);
+    bench(tree, "local 65536", n, 65536);
+    bench(tree, "uniform", n, -1);
+    return 0;
+}
@@ -0,0 +1,179 @@
+// bench_flat_ordered.cpp
+// Benchmark: Treap vs. FlatOrderedMap on the same read-heavy operation mix.
+//
+// Both maps get N random keys from [0, 2N) inserted one by one in random
+// order; the flat map is also built with a single insert_batch. Then QUERIES
+// random keys (or ranks) are run through find, lower_bound, find + rank and
+// kth, and the whole map is walked with successor. Erase shifts the array,
+// so only ERASES keys are erased.
+//
+// Usage: ./bin/bench_flat_ordered [N ...]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "FlatOrderedMap.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+static const int ERASES = 10000;
+
+typedef TreapNode<int, int> Node;
+typedef FlatOrderedMap<int, int>::cursor Cursor;
+
+static void report(char const* name, int ops, double t_treap, double t_flat,
+                   long sum_treap, long sum_flat) {
+    if (sum_treap != sum_flat) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    std::printf("  %-12s treap %7.2f Mop/s   flat %8.2f Mop/s   speedup "
+                "%.2fx\n",
+                name, ops / t_treap / 1e6, ops / t_flat / 1e6,
+                t_treap / t_flat);
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    int* keys = new int[n];
+    int* values = new int[n];
+    for (int i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(rng.next() % key_range);
+        values[i] = i;
+    }
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+
+    // insert
+    Treap<int, int> treap;
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        treap.insert(keys[i], i);
+    }
+    double t_treap = seconds_since(start);
+    FlatOrderedMap<int, int> flat;
+    start = clock();
+    for (int i = 0; i < n; ++i) {
+        flat.insert(keys[i], i);
+    }
+    std::printf("N = %d (%d keys)\n", n, treap.size());
+    report("insert", n, t_treap, seconds_since(start), treap.size(),
+           flat.size());
+    FlatOrderedMap<int, int> batched;
+    start = clock();
+    batched.insert_batch(keys, values, n);
+    report("insert_batch", n, t_treap, seconds_since(start), treap.size(),
+           batched.size());
+
+    // find
+    long sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = treap.find(queries[i]);
+        sum_treap += (found == 0) ? -1 : found->value;
+    }
+    t_treap = seconds_since(start);
+    long sum_flat = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Cursor found = flat.find(queries[i]);
+        sum_flat += found.is_set() ? flat.value(found) : -1;
+    }
+    report("find", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_flat);
+
+    // lower_bound
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = treap.lower_bound(queries[i]);
+        sum_treap += (found == 0) ? -1 : found->value;
+    }
+    t_treap = seconds_since(start);
+    sum_flat = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Cursor found = flat.lower_bound(queries[i]);
+        sum_flat += found.is_set() ? flat.value(found) : -1;
+    }
+    report("lower_bound", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_flat);
+
+    // find + rank
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += treap.rank(treap.find(queries[i]));
+    }
+    t_treap = seconds_since(start);
+    sum_flat = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_flat += flat.rank(flat.find(queries[i]));
+    }
+    report("find + rank", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_flat);
+
+    // kth
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += treap.kth(queries[i] % treap.size())->value;
+    }
+    t_treap = seconds_since(start);
+    sum_flat = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_flat += flat.value(flat.kth(queries[i] % flat.size()));
+    }
+    report("kth", QUERIES, t_treap, seconds_since(start), sum_treap,
+           sum_flat);
+
+    // in-order walk
+    sum_treap = 0;
+    start = clock();
+    for (Node* node = treap.front(); node != 0;
+         node = treap.successor(node)) {
+        sum_treap += node->value;
+    }
+    t_treap = seconds_since(start);
+    sum_flat = 0;
+    start = clock();
+    for (Cursor c = flat.front(); c.is_set(); c = flat.successor(c)) {
+        sum_flat += flat.value(c);
+    }
+    report("successor", treap.size(), t_treap, seconds_since(start),
+           sum_treap, sum_flat);
+
+    // erase the first ERASES inserted keys
+    int erases = (n < ERASES) ? n : ERASES;
+    start = clock();
+    for (int i = 0; i < erases; ++i) {
+        treap.erase(treap.find(keys[i]));
+    }
+    t_treap = seconds_since(start);
+    start = clock();
+    for (int i = 0; i < erases; ++i) {
+        flat.erase(flat.find(keys[i]));
+    }
+    report("find + erase", erases, t_treap, seconds_since(start),
+           treap.size(), flat.size());
+
+    delete[] keys;
+    delete[] values;
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// bench_frozen.cpp
+// Benchmark: queries on a Treap vs. on its frozen EytzingerIndex snapshot.
+//
+// The treap is filled by inserting N random keys from [0, 2N) in random order
+// and then frozen. QUERIES random keys (or ranks) are run through
+// lower_bound, find + rank, and kth on both.
+//
+// Usage: ./bin/bench_frozen [N ...]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+
+typedef TreapNode<int, int> Node;
+
+static void report(char const* name, double t_treap, double t_frozen,
+                   long sum_treap, long sum_frozen) {
+    if (sum_treap != sum_frozen) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    std::printf("  %-12s treap %7.2f Mq/s   frozen %8.2f Mq/s   speedup "
+                "%.2fx\n",
+                name, QUERIES / t_treap / 1e6, QUERIES / t_frozen / 1e6,
+                t_treap / t_frozen);
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    Treap<int, int> tree;
+    for (int i = 0; i < n; ++i) {
+        tree.insert(static_cast<int>(rng.next() % key_range), i);
+    }
+    clock_t start = clock();
+    EytzingerIndex<int, int> frozen;
+    tree.freeze(frozen);
+    double t_freeze = seconds_since(start);
+    std::printf("N = %d (%d nodes), freeze %.3f s\n", n, tree.size(),
+                t_freeze);
+
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+
+    // lower_bound
+    long sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = tree.lower_bound(queries[i]);
+        sum_treap += (found == 0) ? -1 : found->value;
+    }
+    double t_treap = seconds_since(start);
+    long sum_frozen = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        int found = frozen.lower_bound(queries[i]);
+        sum_frozen += (found < 0) ? -1 : frozen.value(found);
+    }
+    report("lower_bound", t_treap, seconds_since(start), sum_treap,
+           sum_frozen);
+
+    // rank of a key (find + rank on the treap)
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += tree.rank(tree.find(queries[i]));
+    }
+    t_treap = seconds_since(start);
+    sum_frozen = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_frozen += frozen.rank(queries[i]);
+    }
+    report("find + rank", t_treap, seconds_since(start), sum_treap,
+           sum_frozen);
+
+    // kth
+    sum_treap = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_treap += tree.kth(queries[i] % tree.size())->value;
+    }
+    t_treap = seconds_since(start);
+    sum_frozen = 0;
+    start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        sum_frozen += frozen.value(frozen.kth(queries[i] % frozen.size()));
+    }
+    report("kth", t_treap, seconds_since(start), sum_treap, sum_frozen);
+
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
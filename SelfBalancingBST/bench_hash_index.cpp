@@ -0,0 +1,107 @@
+// bench_hash_index.cpp
+// Benchmark: Treap::find with and without the TreapHashIndex.
+//
+// Both treaps get N random keys from [0, 2N) inserted in random order. Then
+// QUERIES lookups run for keys known to be present (hits) and for uniform
+// keys (about 40% hits). The memory of the index is reported next to the
+// memory of the nodes.
+//
+// Usage: ./bin/bench_hash_index [N ...]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 2000000;
+
+typedef Treap<int, int> PlainTreap;
+typedef Treap<int, int, TreapNoAggregate, TreapHashIndex> IndexedTreap;
+typedef TreapNode<int, int> Node;
+
+static void report(char const* name, int ops, double t_plain,
+                   double t_indexed, long sum_plain, long sum_indexed) {
+    if (sum_plain != sum_indexed) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    std::printf("  %-12s tree %7.2f Mop/s   indexed %8.2f Mop/s   speedup "
+                "%.2fx\n",
+                name, ops / t_plain / 1e6, ops / t_indexed / 1e6,
+                t_plain / t_indexed);
+}
+
+template <typename Tree>
+static long lookups(Tree& tree, const int* queries, double& seconds) {
+    long sum = 0;
+    clock_t start = clock();
+    for (int i = 0; i < QUERIES; ++i) {
+        Node* found = tree.find(queries[i]);
+        sum += (found == 0) ? -1 : found->value;
+    }
+    seconds = seconds_since(start);
+    return sum;
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int key_range = 2 * n;
+    int* keys = new int[n];
+    for (int i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(rng.next() % key_range);
+    }
+
+    PlainTreap plain;
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        plain.insert(keys[i], i);
+    }
+    double t_plain = seconds_since(start);
+    IndexedTreap indexed;
+    start = clock();
+    for (int i = 0; i < n; ++i) {
+        indexed.insert(keys[i], i);
+    }
+    double t_indexed = seconds_since(start);
+
+    int nodes = plain.size();
+    std::printf("N = %d (%d keys)\n", n, nodes);
+    std::printf("  memory       nodes %.1f MB (%d B each)   index %.1f MB "
+                "(%.1f B per key)\n",
+                nodes * double(sizeof(Node)) / 1e6,
+                static_cast<int>(sizeof(Node)),
+                indexed.find_index_bytes() / 1e6,
+                double(indexed.find_index_bytes()) / nodes);
+    report("insert", n, t_plain, t_indexed, plain.size(), indexed.size());
+
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = keys[rng.next() % n];
+    }
+    long sum_plain = lookups(plain, queries, t_plain);
+    long sum_indexed = lookups(indexed, queries, t_indexed);
+    report("find (hits)", QUERIES, t_plain, t_indexed, sum_plain,
+           sum_indexed);
+
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % key_range);
+    }
+    sum_plain = lookups(plain, queries, t_plain);
+    sum_indexed = lookups(indexed, queries, t_indexed);
+    report("find (mixed)", QUERIES, t_plain, t_indexed, sum_plain,
+           sum_indexed);
+
+    delete[] keys;
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
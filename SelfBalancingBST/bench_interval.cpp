@@ -0,0 +1,167 @@
+// bench_interval.cpp
+// Benchmark: IntervalTreap queries vs. a full scan over the intervals.
+//
+// N intervals get random starts in [0, 16N) and random lengths in [1, 64],
+// so a point lies in about two of them. QUERIES random windows of width 64
+// go through overlapping(), and QUERIES random points through both forms of
+// stab() (all containing intervals, and the innermost one). The scan
+// answers the same queries by testing every interval in a flat array. It
+// is slow, so it only runs the first SCAN_QUERIES queries; rates are
+// reported per query.
+//
+// Usage: ./bin/bench_interval [N ...]   (default: 1000000)
+
+#include "BenchUtil.h"
+#include "IntervalTreap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const int QUERIES = 200000;
+static const int SCAN_QUERIES = 200;
+static const int WINDOW = 64;
+
+typedef IntervalTreap<int, int> Intervals;
+typedef Intervals::node_type Node;
+
+// Sums the values it is called with.
+struct SumValues {
+    long sum;
+    SumValues() : sum(0) {}
+    void operator()(const int&, const int&, const int& value) {
+        sum += value;
+    }
+};
+
+static void report(char const* name, double t_scan, double t_tree,
+                   long sum_scan, long sum_tree) {
+    if (sum_scan != sum_tree) {
+        std::printf("  checksum mismatch for %s\n", name);
+    }
+    double scan_rate = SCAN_QUERIES / t_scan;
+    double tree_rate = QUERIES / t_tree;
+    std::printf("  %-12s scan %9.1f q/s   interval treap %11.1f q/s   "
+                "speedup %.0fx\n",
+                name, scan_rate, tree_rate, tree_rate / scan_rate);
+}
+
+static void bench(int n) {
+    XorShift32 rng(2463534242u);
+    int start_range = 16 * n;
+    Intervals intervals;
+    // The scan's copy of the intervals.
+    int* starts = new int[n];
+    int* ends = new int[n];
+    int* values = new int[n];
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        int start = static_cast<int>(rng.next() % start_range);
+        int length = 1 + static_cast<int>(rng.next() % WINDOW);
+        intervals.insert(start, start + length, i);
+        starts[count] = start;
+        ends[count] = start + length;
+        values[count] = i;
+        ++count;
+    }
+    int* queries = new int[QUERIES];
+    for (int i = 0; i < QUERIES; ++i) {
+        queries[i] = static_cast<int>(rng.next() % start_range);
+    }
+    std::printf("N = %d (%d intervals)\n", n, count);
+
+    // overlapping [q, q + WINDOW)
+    long sum_scan = 0;
+    clock_t start = clock();
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        int lo = queries[q];
+        int hi = lo + WINDOW;
+        for (int i = 0; i < count; ++i) {
+            if (starts[i] < hi && lo < ends[i]) {
+                sum_scan += values[i];
+            }
+        }
+    }
+    double t_scan = seconds_since(start);
+    SumValues checked;
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        intervals.overlapping(queries[q], queries[q] + WINDOW, checked);
+    }
+    SumValues all;
+    start = clock();
+    for (int q = 0; q < QUERIES; ++q) {
+        intervals.overlapping(queries[q], queries[q] + WINDOW, all);
+    }
+    report("overlapping", t_scan, seconds_since(start), sum_scan,
+           checked.sum);
+
+    // stab(point, callback)
+    sum_scan = 0;
+    start = clock();
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        int point = queries[q];
+        for (int i = 0; i < count; ++i) {
+            if (starts[i] <= point && point < ends[i]) {
+                sum_scan += values[i];
+            }
+        }
+    }
+    t_scan = seconds_since(start);
+    checked = SumValues();
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        intervals.stab(queries[q], checked);
+    }
+    all = SumValues();
+    start = clock();
+    for (int q = 0; q < QUERIES; ++q) {
+        intervals.stab(queries[q], all);
+    }
+    report("stab (all)", t_scan, seconds_since(start), sum_scan,
+           checked.sum);
+
+    // stab(point): the containing interval with the largest start
+    sum_scan = 0;
+    start = clock();
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        int point = queries[q];
+        int found = -1;
+        int found_start = -1;
+        for (int i = 0; i < count; ++i) {
+            if (starts[i] <= point && point < ends[i] &&
+                found_start <= starts[i]) { // Ties: the last inserted.
+                found = values[i];
+                found_start = starts[i];
+            }
+        }
+        sum_scan += found;
+    }
+    t_scan = seconds_since(start);
+    long sum_checked = 0;
+    for (int q = 0; q < SCAN_QUERIES; ++q) {
+        Node* found = intervals.stab(queries[q]);
+        sum_checked += (found == 0) ? -1 : found->value.value;
+    }
+    all = SumValues();
+    start = clock();
+    for (int q = 0; q < QUERIES; ++q) {
+        Node* found = intervals.stab(queries[q]);
+        all.sum += (found == 0) ? -1 : found->value.value;
+    }
+    report("stab (inner)", t_scan, seconds_since(start), sum_scan,
+           sum_checked);
+
+    delete[] starts;
+    delete[] ends;
+    delete[] values;
+    delete[] queries;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            bench(std::atoi(argv[i]));
+        }
+    } else {
+        bench(1000000);
+    }
+    return 0;
+}
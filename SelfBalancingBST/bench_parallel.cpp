@@ -0,0 +1,106 @@
+// bench_parallel.cpp
+// Benchmark: sequential vs. fork-join parallel Treap bulk operations.
+//
+// Two treaps of N keys each are built from sorted random keys in [0, 4N)
+// (so about a quarter of the keys are shared) and combined with set_union,
+// set_intersection and set_difference; filter keeps the even keys. Every
+// operation runs once without a pool and once per thread count on a
+// ForkJoinPool, on fresh copies of the inputs.
+//
+// Usage: ./bin/bench_parallel [N [threads ...]]   (default: 10000000 1 2 4)
+
+#include "BenchUtil.h"
+#include "ParallelTreap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+struct EvenKey {
+    bool operator()(const int& key, const int&) const {
+        return key % 2 == 0;
+    }
+};
+
+// n sorted distinct keys from [0, range), drawn by sampling each key with
+// probability n / range.
+static int sorted_keys(XorShift32& rng, int n, int range, int* keys) {
+    int count = 0;
+    for (int key = 0; key < range && count < n; ++key) {
+        if (rng.next() % static_cast<unsigned int>(range) <
+            static_cast<unsigned int>(n)) {
+            keys[count++] = key;
+        }
+    }
+    return count;
+}
+
+enum Operation { OP_BUILD, OP_UNION, OP_INTERSECTION, OP_DIFFERENCE,
+                 OP_FILTER };
+
+// Runs one operation on the inputs; pool may be NULL. Returns seconds.
+static double run(Operation op, const int* keys_a, int n_a, const int* keys_b,
+                  int n_b, ForkJoinPool* pool, int& result_size) {
+    ParallelTreap<int, int> a;
+    ParallelTreap<int, int> b;
+    double start = wall_seconds();
+    if (op == OP_BUILD) {
+        if (pool != 0) {
+            a.build_from_sorted(keys_a, keys_a, n_a, *pool);
+        } else {
+            a.build_from_sorted(keys_a, keys_a, n_a);
+        }
+        result_size = a.size();
+        return wall_seconds() - start;
+    }
+    a.build_from_sorted(keys_a, keys_a, n_a);
+    b.build_from_sorted(keys_b, keys_b, n_b);
+    start = wall_seconds();
+    if (op == OP_UNION) {
+        pool != 0 ? a.set_union(b, *pool) : a.set_union(b);
+    } else if (op == OP_INTERSECTION) {
+        pool != 0 ? a.set_intersection(b, *pool) : a.set_intersection(b);
+    } else if (op == OP_DIFFERENCE) {
+        pool != 0 ? a.set_difference(b, *pool) : a.set_difference(b);
+    } else {
+        pool != 0 ? a.filter(EvenKey(), *pool) : a.filter(EvenKey());
+    }
+    result_size = a.size();
+    return wall_seconds() - start;
+}
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? std::atoi(argv[1]) : 10000000;
+    int default_threads[] = {1, 2, 4};
+    int thread_counts = (argc > 2) ? argc - 2 : 3;
+
+    XorShift32 rng(2463534242u);
+    int* keys_a = new int[n];
+    int* keys_b = new int[n];
+    int n_a = sorted_keys(rng, n, 4 * n, keys_a);
+    int n_b = sorted_keys(rng, n, 4 * n, keys_b);
+    std::printf("N = %d (%d + %d keys)\n", n, n_a, n_b);
+
+    char const* names[] = {"build", "union", "intersection", "difference",
+                           "filter"};
+    for (int op = OP_BUILD; op <= OP_FILTER; ++op) {
+        int expected;
+        double t_seq = run(static_cast<Operation>(op), keys_a, n_a, keys_b,
+                           n_b, 0, expected);
+        std::printf("  %-12s sequential %7.3f s\n", names[op], t_seq);
+        for (int i = 0; i < thread_counts; ++i) {
+            int threads = (argc > 2) ? std::atoi(argv[2 + i])
+                                     : default_threads[i];
+            ForkJoinPool pool(threads);
+            int size;
+            double t_par = run(static_cast<Operation>(op), keys_a, n_a,
+                               keys_b, n_b, &pool, size);
+            std::printf("  %-12s %2d threads %7.3f s   speedup %.2fx%s\n",
+                        names[op], pool.thread_count(), t_par, t_seq / t_par,
+                        size == expected ? "" : "   size mismatch");
+        }
+    }
+
+    delete[] keys_a;
+    delete[] keys_b;
+    return 0;
+}
@@ -1,20 +1,116 @@
-#include "SelfBalancingBST.h"
 #include <cassert>
 #include <iostream>
 
+// Build with -DBST_USE_ARENA to run the same ops on ArenaTreap (cursors are
+// pool handles), with -DBST_USE_PERSISTENT on PersistentTreap (cursors are
+// root-to-node paths and `a` is an O(1) snapshot), with -DBST_USE_BPLUS on
+// BPlusTree (cursors are leaf positions), or with -DBST_USE_FLAT on
+// FlatOrderedMap (cursors are array positions). -DBST_USE_HASH_INDEX keeps
+// Treap but adds its hash index, so `?` is O(1) expected.
+#if defined(BST_USE_ARENA)
+#include "ArenaTreap.h"
+typedef ArenaTreap<int, int> tree_type;
+typedef ArenaTreap<int, int>::handle cursor_type;
+static const cursor_type NO_CURSOR = 0;
+
+static bool cursor_is_set(cursor_type cursor) {
+    return cursor != NO_CURSOR;
+}
+
+static int cursor_value(tree_type& tree, cursor_type& cursor) {
+    return tree.value(cursor);
+}
+
+static void set_cursor_value(tree_type& tree, cursor_type& cursor, int value) {
+    tree.value(cursor) = value;
+}
+#elif defined(BST_USE_PERSISTENT)
+#include "PersistentTreap.h"
+typedef PersistentTreap<int, int> tree_type;
+typedef PersistentTreap<int, int>::cursor cursor_type;
+static const cursor_type NO_CURSOR = cursor_type();
+
+static bool cursor_is_set(cursor_type const& cursor) {
+    return cursor.is_set();
+}
+
+static int cursor_value(tree_type&, cursor_type& cursor) {
+    return cursor.value();
+}
+
+static void set_cursor_value(tree_type& tree, cursor_type& cursor, int value) {
+    tree.set_value(cursor, value);
+}
+#elif defined(BST_USE_BPLUS)
+#include "BPlusTree.h"
+typedef BPlusTree<int, int> tree_type;
+typedef BPlusTree<int, int>::cursor cursor_type;
+static const cursor_type NO_CURSOR = cursor_type();
+
+static bool cursor_is_set(cursor_type const& cursor) {
+    return cursor.is_set();
+}
+
+static int cursor_value(tree_type&, cursor_type& cursor) {
+    return cursor.value();
+}
+
+static void set_cursor_value(tree_type&, cursor_type& cursor, int value) {
+    cursor.value() = value;
+}
+#elif defined(BST_USE_FLAT)
+#include "FlatOrderedMap.h"
+typedef FlatOrderedMap<int, int> tree_type;
+typedef FlatOrderedMap<int, int>::cursor cursor_type;
+static const cursor_type NO_CURSOR = cursor_type();
+
+static bool cursor_is_set(cursor_type const& cursor) {
+    return cursor.is_set();
+}
+
+static int cursor_value(tree_type& tree, cursor_type& cursor) {
+    return tree.value(cursor);
+}
+
+static void set_cursor_value(tree_type& tree, cursor_type& cursor, int value) {
+    tree.value(cursor) = value;
+}
+#else
+#include "SelfBalancingBST.h"
+#if defined(BST_USE_HASH_INDEX)
+typedef Treap<int, int, TreapNoAggregate, TreapHashIndex> tree_type;
+#else
+typedef Treap<int, int> tree_type;
+#endif
+typedef TreapNode<int, int>* cursor_type;
+static const cursor_type NO_CURSOR = NULL;
+
+static bool cursor_is_set(cursor_type cursor) {
+    return cursor != NO_CURSOR;
+}
+
+static int cursor_value(tree_type&, cursor_type& cursor) {
+    return cursor->value;
+}
+
+static void set_cursor_value(tree_type&, cursor_type& cursor, int value) {
+    cursor->value = value;
+}
+#endif
+
 using std::cin;
 using std::cout;
 using std::ws;
 
-Treap<int, int> trees[1000];
-TreapNode<int, int>* cursors[1000];
+tree_type trees[1000];
+cursor_type cursors[1000];
 
 int main() {
     int q;
     cin >> q;
 
     for (int i = 0; i < 1000; i++) {
-        cursors[i] = NULL; // or other sentinel value
+        cursors[i] = NO_CURSOR; // or other sentinel value
     }
 
     for (int i = 0; i < q; i++) {
@@ -30,7 +126,7 @@ int main() {
             cin >> other;
             other--;
             trees[instance] = trees[other];
-            cursors[instance] = NULL; // or other sentinel value
+            cursors[instance] = NO_CURSOR; // or other sentinel value
         } else if (op == '?') {
             int key;
             cin >> key;
@@ -49,7 +145,7 @@ int main() {
             cursors[instance] = trees[instance].insert(key, value);
         } else if (op == 'e') {
             trees[instance].erase(cursors[instance]);
-            cursors[instance] = NULL; // or other sentinel value
+            cursors[instance] = NO_CURSOR; // or other sentinel value
         } else if (op == 'f') {
             cursors[instance] = trees[instance].front();
         } else if (op == 'b') {
@@ -60,7 +156,7 @@ int main() {
             cursors[instance] = trees[instance].predecessor(cursors[instance]);
         } else if (op == 'r') {
             // or other sentinel value
-            if (cursors[instance] == NULL) {
+            if (!cursor_is_set(cursors[instance])) {
                 cout << "-\n";
             } else {
                 cout << trees[instance].rank(cursors[instance]) << '\n';
@@ -71,17 +167,18 @@ int main() {
             cursors[instance] = trees[instance].kth(k);
         } else if (op == 'g') {
             // or other sentinel value
-            if (cursors[instance] == NULL) {
+            if (!cursor_is_set(cursors[instance])) {
                 cout << "-\n";
             } else {
-                cout << cursors[instance]->value << '\n';
+                cout << cursor_value(trees[instance], cursors[instance])
+                     << '\n';
             }
         } else if (op == 's') {
             int value;
             cin >> value;
             // or other sentinel value
-            if (cursors[instance] != NULL) {
-                cursors[instance]->value = value;
+            if (cursor_is_set(cursors[instance])) {
+                set_cursor_value(trees[instance], cursors[instance], value);
             }
         } else if (op == 'z') {
             cout << trees[instance].size() << '\n';
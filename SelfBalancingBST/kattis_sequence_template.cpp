@@ -0,0 +1,124 @@
+// kattis_sequence_template.cpp
+// Kattis-style main template for SequenceTreap (positional sequence ops)
+
+#include "SequenceTreap.h"
+#include <cassert>
+#include <iostream>
+
+using std::cin;
+using std::cout;
+using std::ws;
+
+static const int MAX_INSTANCES = 1000;
+static const int MAX_BATCH = 100000;
+
+SequenceTreap<long> sequences[MAX_INSTANCES];
+long values[MAX_BATCH];
+
+// Operations on sequence i (positions from 0, ranges [l, r)):
+//   a j        copy sequence j
+//   b n v...   replace with the n values (O(n) build)
+//   i p v      insert v at p            e p      erase at p
+//   g p        print the value at p     u p v    set the value at p
+//   E l r      erase_range              r l r    reverse
+//   = l r v    assign v                 + l r v  add v
+//   s l r      print the sum            n        print the size
+//   x p j      split: [p, size) moves to j
+//   c j        append j (j is left empty)
+//   p          print the whole sequence
+int main() {
+    int q;
+    cin >> q;
+
+    for (int i = 0; i < q; i++) {
+        int instance;
+        cin >> instance;
+        instance--;
+
+        cin >> ws;
+        char op;
+        cin >> op;
+
+        SequenceTreap<long>& seq = sequences[instance];
+        if (op == 'a') {
+            int other;
+            cin >> other;
+            other--;
+            seq = sequences[other];
+        } else if (op == 'b') {
+            int n;
+            cin >> n;
+            assert(n <= MAX_BATCH);
+            for (int j = 0; j < n; j++) {
+                cin >> values[j];
+            }
+            seq = SequenceTreap<long>(values, n);
+        } else if (op == 'i') {
+            int pos;
+            long value;
+            cin >> pos >> value;
+            seq.insert(pos, value);
+        } else if (op == 'e') {
+            int pos;
+            cin >> pos;
+            seq.erase(pos);
+        } else if (op == 'g') {
+            int pos;
+            cin >> pos;
+            cout << seq.get(pos) << '\n';
+        } else if (op == 'u') {
+            int pos;
+            long value;
+            cin >> pos >> value;
+            seq.set(pos, value);
+        } else if (op == 'E' || op == 'r' || op == 's') {
+            int first;
+            int last;
+            cin >> first >> last;
+            if (op == 'E') {
+                seq.erase_range(first, last);
+            } else if (op == 'r') {
+                seq.reverse(first, last);
+            } else {
+                cout << seq.sum(first, last) << '\n';
+            }
+        } else if (op == '=' || op == '+') {
+            int first;
+            int last;
+            long value;
+            cin >> first >> last >> value;
+            if (op == '=') {
+                seq.assign(first, last, value);
+            } else {
+                seq.add(first, last, value);
+            }
+        } else if (op == 'n') {
+            cout << seq.size() << '\n';
+        } else if (op == 'x') {
+            int pos;
+            int other;
+            cin >> pos >> other;
+            other--;
+            seq.split(pos, sequences[other]);
+        } else if (op == 'c') {
+            int other;
+            cin >> other;
+            other--;
+            seq.append(sequences[other]);
+        } else if (op == 'p') {
+            int n = seq.size();
+            assert(n <= MAX_BATCH);
+            seq.to_array(values);
+            for (int j = 0; j < n; j++) {
+                cout << values[j] << (j + 1 < n ? ' ' : '\n');
+            }
+            if (n == 0) {
+                cout << '\n';
+            }
+        } else {
+            assert(false);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+// test_concurrent.cpp
+// Test: ConcurrentTreap readers see consistent snapshots while a writer
+// inserts and erases, and retired nodes are only freed once no reader can
+// reach them. Meant to be run under ASan and TSan as well (see README).
+//
+// Even keys in [0, KEY_RANGE) are inserted up front and never erased; the
+// writer inserts and erases random odd keys. Every key maps to key * 3, so
+// each reader checks that all even keys are found with their value, that
+// any odd key found has its value, and that lower_bound never skips an
+// even key.
+//
+// Usage: ./bin/test_concurrent   (prints "ok" and exits 0 on success)
+
+#include "BenchUtil.h"
+#include "ConcurrentTreap.h"
+#include <cstdio>
+
+static const int READERS = 4;
+static const int KEY_RANGE = 4000;
+static const int WRITES = 200000;
+
+typedef ConcurrentTreap<int, int> tree_type;
+typedef ConcurrentTreapReader<int, int> reader_type;
+
+struct Shared {
+    tree_type* tree;
+    int stop;
+    int failures;
+};
+
+struct ReaderArgs {
+    Shared* shared;
+    unsigned int seed;
+};
+
+static void* reader_main(void* argument) {
+    ReaderArgs* args = static_cast<ReaderArgs*>(argument);
+    Shared* shared = args->shared;
+    XorShift32 rng(args->seed);
+    reader_type reader(*shared->tree);
+    int failures = 0;
+    while (!__atomic_load_n(&shared->stop, __ATOMIC_RELAXED)) {
+        int key = static_cast<int>(rng.next() % KEY_RANGE);
+        int value = -1;
+        bool found = reader.find(key, value);
+        if (key % 2 == 0 && !found) {
+            ++failures;
+        }
+        if (found && value != key * 3) {
+            ++failures;
+        }
+        int found_key = -1;
+        if (reader.lower_bound(key, found_key, value)) {
+            int next_even = key + (key % 2);
+            if (found_key < key || (next_even < KEY_RANGE &&
+                                    found_key > next_even) ||
+                value != found_key * 3) {
+                ++failures;
+            }
+        }
+    }
+    __atomic_fetch_add(&shared->failures, failures, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int main() {
+    tree_type tree;
+    for (int key = 0; key < KEY_RANGE; key += 2) {
+        tree.insert(key, key * 3);
+    }
+    Shared shared;
+    shared.tree = &tree;
+    shared.stop = 0;
+    shared.failures = 0;
+
+    pthread_t threads[READERS];
+    ReaderArgs args[READERS];
+    for (int i = 0; i < READERS; ++i) {
+        args[i].shared = &shared;
+        args[i].seed = 12345u + 977u * static_cast<unsigned int>(i);
+        pthread_create(&threads[i], 0, reader_main, &args[i]);
+    }
+
+    XorShift32 rng(42);
+    for (int i = 0; i < WRITES; ++i) {
+        int key = 2 * static_cast<int>(rng.next() % (KEY_RANGE / 2)) + 1;
+        if (i % 2 == 0) {
+            tree.insert(key, key * 3);
+        } else {
+            tree.erase(key);
+        }
+    }
+    __atomic_store_n(&shared.stop, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < READERS; ++i) {
+        pthread_join(threads[i], 0);
+    }
+
+    if (tree.size() < KEY_RANGE / 2) {
+        ++shared.failures;
+    }
+    if (shared.failures != 0) {
+        std::printf("FAILED: %d checks\n", shared.failures);
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+// test_parallel.cpp
+// Test: the ParallelTreap bulk operations (build_from_sorted, set_union,
+// set_intersection, set_difference, filter) give the expected keys and a
+// well-formed treap, both sequentially and on a ForkJoinPool.
+//
+// Each round draws two sets of about N random keys from [0, 4N), so about
+// a quarter of them are shared, and runs every operation once without a
+// pool and once with one. N is well above PARALLEL_GRAIN, so the forked
+// paths run. Every key in range is checked against the expected set and
+// value, and the treap for key order, heap order, parent links, subtree
+// sizes and the TreapSum aggregate of every subtree.
+//
+// Usage: ./bin/test_parallel   (prints "ok" and exits 0 on success)
+
+#include "BenchUtil.h"
+#include "ParallelTreap.h"
+#include <cstdio>
+
+static const int ROUNDS = 3;
+static const int THREADS = 4;
+static const int N = 100000;
+static const int KEY_RANGE = 4 * N;
+
+typedef ParallelTreap<int, long, TreapSum<long> > tree_type;
+typedef TreapNode<int, long, TreapSum<long> > node_type;
+
+enum Operation { OP_BUILD, OP_UNION, OP_INTERSECTION, OP_DIFFERENCE,
+                 OP_FILTER };
+
+struct NotMultipleOfThree {
+    bool operator()(const int& key, const long&) const {
+        return key % 3 != 0;
+    }
+};
+
+// Sorted distinct keys from [0, KEY_RANGE), each drawn with probability
+// N / KEY_RANGE; present[key] records them and values are key * 10 + tag.
+static int sorted_keys(XorShift32& rng, int tag, int* keys, long* values,
+                       bool* present) {
+    int count = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        present[key] = rng.next() % KEY_RANGE < static_cast<unsigned int>(N);
+        if (present[key]) {
+            keys[count] = key;
+            values[count] = key * 10L + tag;
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Checks a subtree's shape: keys strictly between lo and hi (when
+ * has_lo / has_hi), parent links, heap order on priorities, subtree sizes
+ * and aggregates.
+ *
+ * @param sum Receives the sum of the subtree's values.
+ * @return The number of broken nodes.
+ */
+static int check_shape(const node_type* node, const node_type* parent,
+                       bool has_lo, int lo, bool has_hi, int hi, long& sum) {
+    sum = 0;
+    if (node == 0) {
+        return 0;
+    }
+    long left_sum;
+    long right_sum;
+    int failures =
+        check_shape(node->left, node, has_lo, lo, true, node->key, left_sum) +
+        check_shape(node->right, node, true, node->key, has_hi, hi,
+                    right_sum);
+    sum = left_sum + node->value + right_sum;
+    if (node->parent != parent || (has_lo && !(lo < node->key)) ||
+        (has_hi && !(node->key < hi)) ||
+        (parent != 0 && node->priority < parent->priority)) {
+        ++failures;
+    }
+    int left_size = (node->left == 0) ? 0 : node->left->subtree_size;
+    int right_size = (node->right == 0) ? 0 : node->right->subtree_size;
+    if (node->subtree_size != 1 + left_size + right_size ||
+        node->aggregate != sum) {
+        ++failures;
+    }
+    return failures;
+}
+
+/**
+ * @brief Checks every key in range: expected[key] tells whether it must be
+ * present, with value key * 10 + 1 if first[key] and key * 10 + 2 if not.
+ *
+ * @return The number of failures, including broken nodes.
+ */
+static int check(tree_type const& tree, const bool* expected,
+                 const bool* first) {
+    long sum;
+    int failures = check_shape(tree.root(), 0, false, 0, false, 0, sum);
+    int count = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        node_type* found = tree.find(key);
+        if ((found != 0) != expected[key]) {
+            ++failures;
+        } else if (found != 0 && found->value != key * 10L +
+                                                     (first[key] ? 1 : 2)) {
+            ++failures;
+        }
+        if (expected[key]) {
+            ++count;
+        }
+    }
+    if (tree.size() != count) {
+        ++failures;
+    }
+    return failures;
+}
+
+// Runs one operation on the inputs (pool may be NULL) and checks it.
+static int run(Operation op, const int* keys_a, const long* values_a, int n_a,
+               const int* keys_b, const long* values_b, int n_b,
+               const bool* in_a, const bool* in_b, bool* expected,
+               ForkJoinPool* pool) {
+    tree_type a;
+    tree_type b;
+    if (op == OP_BUILD && pool != 0) {
+        a.build_from_sorted(keys_a, values_a, n_a, *pool);
+    } else {
+        a.build_from_sorted(keys_a, values_a, n_a);
+    }
+    b.build_from_sorted(keys_b, values_b, n_b);
+    if (op == OP_UNION) {
+        pool != 0 ? a.set_union(b, *pool) : a.set_union(b);
+    } else if (op == OP_INTERSECTION) {
+        pool != 0 ? a.set_intersection(b, *pool) : a.set_intersection(b);
+    } else if (op == OP_DIFFERENCE) {
+        pool != 0 ? a.set_difference(b, *pool) : a.set_difference(b);
+    } else if (op == OP_FILTER) {
+        pool != 0 ? a.filter(NotMultipleOfThree(), *pool)
+                  : a.filter(NotMultipleOfThree());
+    }
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        expected[key] =
+            (op == OP_UNION)          ? (in_a[key] || in_b[key])
+            : (op == OP_INTERSECTION) ? (in_a[key] && in_b[key])
+            : (op == OP_DIFFERENCE)   ? (in_a[key] && !in_b[key])
+            : (op == OP_FILTER)       ? (in_a[key] && key % 3 != 0)
+                                      : in_a[key];
+    }
+    int failures = check(a, expected, in_a);
+    if (op != OP_BUILD && op != OP_FILTER && b.size() != 0) {
+        ++failures;
+    }
+    return failures;
+}
+
+int main() {
+    XorShift32 rng(2463534242u);
+    int* keys_a = new int[KEY_RANGE];
+    int* keys_b = new int[KEY_RANGE];
+    long* values_a = new long[KEY_RANGE];
+    long* values_b = new long[KEY_RANGE];
+    bool* in_a = new bool[KEY_RANGE];
+    bool* in_b = new bool[KEY_RANGE];
+    bool* expected = new bool[KEY_RANGE];
+    ForkJoinPool pool(THREADS);
+    static const char* const NAMES[] = {"build_from_sorted", "set_union",
+                                        "set_intersection", "set_difference",
+                                        "filter"};
+    int failures = 0;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        int n_a = sorted_keys(rng, 1, keys_a, values_a, in_a);
+        int n_b = sorted_keys(rng, 2, keys_b, values_b, in_b);
+        for (int op = OP_BUILD; op <= OP_FILTER; ++op) {
+            for (int parallel = 0; parallel < 2; ++parallel) {
+                int run_failures =
+                    run(static_cast<Operation>(op), keys_a, values_a, n_a,
+                        keys_b, values_b, n_b, in_a, in_b, expected,
+                        parallel ? &pool : 0);
+                if (run_failures != 0) {
+                    std::printf("round %d (%s, %s): %d checks failed\n",
+                                round, NAMES[op],
+                                parallel ? "pool" : "sequential",
+                                run_failures);
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    delete[] keys_a;
+    delete[] keys_b;
+    delete[] values_a;
+    delete[] values_b;
+    delete[] in_a;
+    delete[] in_b;
+    delete[] expected;
+    if (failures != 0) {
+        std::printf("FAILED: %d of %d runs\n", failures, ROUNDS * 10);
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
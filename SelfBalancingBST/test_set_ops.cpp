@@ -0,0 +1,234 @@
+// test_set_ops.cpp
+// Test: the Treap bulk operations (split, join, set_union,
+// set_intersection, set_difference, erase_range, build_from_sorted) leave
+// the expected keys and a well-formed treap, and re-link nodes instead of
+// copying them, so cursors taken before the operation still point at the
+// same key and value afterwards.
+//
+// Each round fills treaps with random overlapping keys, records a cursor
+// for every key of the first one, runs one operation and checks every key
+// in range against the expected set: present keys must be found at their
+// recorded cursor with their original value. The treap itself is checked
+// for key order, heap order, parent links and subtree sizes.
+//
+// Usage: ./bin/test_set_ops   (prints "ok" and exits 0 on success)
+
+#include "BenchUtil.h"
+#include "SelfBalancingBST.h"
+#include <cstdio>
+
+static const int ROUNDS = 50;
+static const int KEYS = 2000;
+static const int KEY_RANGE = 3000;
+
+typedef Treap<int, int> tree_type;
+typedef TreapNode<int, int> node_type;
+
+// Inserts up to KEYS random keys; cursors[key] is the node of each key
+// (NULL when absent), and its value is key * 10 + tag.
+static void fill(tree_type& tree, node_type** cursors, XorShift32& rng,
+                 int tag) {
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        cursors[key] = 0;
+    }
+    for (int i = 0; i < KEYS; ++i) {
+        int key = static_cast<int>(rng.next() % KEY_RANGE);
+        if (cursors[key] == 0) {
+            cursors[key] = tree.insert(key, key * 10 + tag);
+        }
+    }
+}
+
+/**
+ * @brief Checks a subtree's shape: keys strictly between lo and hi (when
+ * has_lo / has_hi), parent links, heap order on priorities and subtree
+ * sizes.
+ *
+ * @return The number of broken nodes.
+ */
+static int check_shape(const node_type* node, const node_type* parent,
+                       bool has_lo, int lo, bool has_hi, int hi) {
+    if (node == 0) {
+        return 0;
+    }
+    int failures = 0;
+    if (node->parent != parent || (has_lo && !(lo < node->key)) ||
+        (has_hi && !(node->key < hi)) ||
+        (parent != 0 && node->priority < parent->priority)) {
+        ++failures;
+    }
+    int left_size = (node->left == 0) ? 0 : node->left->subtree_size;
+    int right_size = (node->right == 0) ? 0 : node->right->subtree_size;
+    if (node->subtree_size != 1 + left_size + right_size) {
+        ++failures;
+    }
+    failures += check_shape(node->left, node, has_lo, lo, true, node->key);
+    failures += check_shape(node->right, node, true, node->key, has_hi, hi);
+    return failures;
+}
+
+/**
+ * @brief Checks every key in range: expected[key] tells whether it must be
+ * present; a present key with a recorded cursor must be found at that
+ * cursor with value key * 10 + tag.
+ *
+ * @return The number of failures, including broken nodes.
+ */
+static int check(tree_type const& tree, const bool* expected,
+                 node_type* const* cursors, int tag) {
+    int failures = check_shape(tree.root(), 0, false, 0, false, 0);
+    int count = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        node_type* found = tree.find(key);
+        if ((found != 0) != expected[key]) {
+            ++failures;
+        } else if (found != 0 && cursors[key] != 0) {
+            if (found != cursors[key] || found->value != key * 10 + tag) {
+                ++failures;
+            }
+        }
+        if (expected[key]) {
+            ++count;
+        }
+    }
+    if (tree.size() != count) {
+        ++failures;
+    }
+    return failures;
+}
+
+// set_union / set_intersection / set_difference on two filled treaps.
+static int set_operation_round(int round, XorShift32& rng,
+                               node_type** first_cursors,
+                               node_type** second_cursors, bool* expected) {
+    tree_type first;
+    tree_type second;
+    fill(first, first_cursors, rng, 1);
+    fill(second, second_cursors, rng, 2);
+    int op = round % 3;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        bool in_first = first_cursors[key] != 0;
+        bool in_second = second_cursors[key] != 0;
+        expected[key] = (op == 0)   ? (in_first || in_second)
+                        : (op == 1) ? (in_first && in_second)
+                                    : (in_first && !in_second);
+    }
+    if (op == 0) {
+        first.set_union(second);
+    } else if (op == 1) {
+        first.set_intersection(second);
+    } else {
+        first.set_difference(second);
+    }
+    int failures = check(first, expected, first_cursors, 1);
+    return (second.size() != 0) ? failures + 1 : failures;
+}
+
+// split at a random key, then join the halves back together.
+static int split_join_round(XorShift32& rng, node_type** cursors,
+                            bool* expected) {
+    tree_type left;
+    tree_type right;
+    fill(left, cursors, rng, 1);
+    right.insert(-1, 0); // Freed by the split.
+    int split_key = static_cast<int>(rng.next() % (KEY_RANGE + 1));
+    left.split(split_key, right);
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        expected[key] = cursors[key] != 0 && key < split_key;
+    }
+    int failures = check(left, expected, cursors, 1);
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        expected[key] = cursors[key] != 0 && !(key < split_key);
+    }
+    failures += check(right, expected, cursors, 1);
+    left.join(right);
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        expected[key] = cursors[key] != 0;
+    }
+    failures += check(left, expected, cursors, 1);
+    return (right.size() != 0) ? failures + 1 : failures;
+}
+
+// erase_range over a random [lo, hi).
+static int erase_range_round(XorShift32& rng, node_type** cursors,
+                             bool* expected) {
+    tree_type tree;
+    fill(tree, cursors, rng, 1);
+    int lo = static_cast<int>(rng.next() % KEY_RANGE);
+    int hi = lo + static_cast<int>(rng.next() % (KEY_RANGE - lo + 1));
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        expected[key] = cursors[key] != 0 && (key < lo || !(key < hi));
+        if (!expected[key]) {
+            cursors[key] = 0; // Freed by erase_range.
+        }
+    }
+    tree.erase_range(lo, hi);
+    return check(tree, expected, cursors, 1);
+}
+
+// build_from_sorted over random sorted keys, replacing earlier contents.
+static int build_round(XorShift32& rng, node_type** cursors, bool* expected) {
+    tree_type tree;
+    fill(tree, cursors, rng, 2); // Freed by the build.
+    int* keys = new int[KEY_RANGE];
+    int* values = new int[KEY_RANGE];
+    int n = 0;
+    for (int key = 0; key < KEY_RANGE; ++key) {
+        cursors[key] = 0;
+        expected[key] = (rng.next() % 3) == 0;
+        if (expected[key]) {
+            keys[n] = key;
+            values[n] = key * 10 + 1;
+            ++n;
+        }
+    }
+    tree.build_from_sorted(keys, values, n);
+    delete[] keys;
+    delete[] values;
+    return check(tree, expected, cursors, 1);
+}
+
+int main() {
+    XorShift32 rng(2463534242u);
+    node_type** first_cursors = new node_type*[KEY_RANGE];
+    node_type** second_cursors = new node_type*[KEY_RANGE];
+    bool* expected = new bool[KEY_RANGE];
+    static const char* const NAMES[] = {
+        "set_union", "set_intersection", "set_difference",
+        "split / join", "erase_range", "build_from_sorted"};
+    int failures = 0;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int op = 0; op < 6; ++op) {
+            int round_failures;
+            if (op < 3) {
+                round_failures =
+                    set_operation_round(op, rng, first_cursors,
+                                        second_cursors, expected);
+            } else if (op == 3) {
+                round_failures =
+                    split_join_round(rng, first_cursors, expected);
+            } else if (op == 4) {
+                round_failures =
+                    erase_range_round(rng, first_cursors, expected);
+            } else {
+                round_failures = build_round(rng, first_cursors, expected);
+            }
+            if (round_failures != 0) {
+                std::printf("round %d (%s): %d checks failed\n", round,
+                            NAMES[op], round_failures);
+                ++failures;
+            }
+        }
+    }
+
+    delete[] first_cursors;
+    delete[] second_cursors;
+    delete[] expected;
+    if (failures != 0) {
+        std::printf("FAILED: %d of %d rounds\n", failures, 6 * ROUNDS);
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
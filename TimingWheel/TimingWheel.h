@@ -0,0 +1,282 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+// C++98-only, no STL containers. Header defines templated implementation.
+#include "Dequeue.h"
+#include <cassert>
+
+/**
+ * TimerNode
+ * An intrusive ring node, laid out like the DoublyLinkedList Node<T>, that
+ * also remembers when it expires. A pointer to a TimerNode is the handle
+ * returned by TimingWheel::schedule().
+ */
+template <typename T> struct TimerNode {
+    TimerNode* prev; // Previous node in the bucket ring.
+    TimerNode* next; // Next node in the bucket ring (or free list link).
+    unsigned int expiry; // Absolute tick at which the timer fires.
+    T data;              // Payload handed back on expiry.
+
+    // Sentinel constructor: an empty ring points at itself.
+    TimerNode() : prev(this), next(this), expiry(0), data() {}
+};
+
+/**
+ * TimingWheel
+ * A hierarchical timing wheel (Varghese & Lauck) with LEVELS levels of
+ * SLOTS buckets each. Level k covers delays below SLOTS^(k + 1) ticks with a
+ * granularity of SLOTS^k ticks; when the lower levels wrap, the matching
+ * bucket of the next level is cascaded down and re-placed.
+ *
+ * Every bucket is a circular list with a sentinel (as in DoublyLinkedList),
+ * so scheduling and cancelling are O(1) pointer splices. Nodes come from a
+ * block pool with a free list, so steady-state scheduling does not allocate.
+ *
+ * Invariants:
+ *  - current_ is the last tick that has been processed by advance().
+ *  - Every live timer has expiry in (current_, current_ + 2^32).
+ *  - size_ is the number of live (scheduled, not yet expired) timers.
+ */
+template <typename T> struct TimingWheel {
+  private:
+    typedef TimerNode<T> TNode;
+
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4; // 4 * 8 bits covers the 32-bit tick range.
+    static const int BLOCK_NODES = 256;
+
+    TNode wheel_[LEVELS][SLOTS];
+    unsigned int current_;
+    int size_;
+
+    TNode* free_list_; // Recycled nodes, chained through next.
+    TNode** blocks_;   // Every block allocated by the pool.
+    int block_count_;
+    int block_capacity_;
+
+    /**
+     * @brief Takes a node from the free list, allocating a new block of
+     * BLOCK_NODES nodes when the free list is empty.
+     *
+     * @return A node that is not linked into any bucket.
+     */
+    TNode* acquire_node() {
+        if (free_list_ == 0) {
+            if (block_count_ == block_capacity_) {
+                int new_cap = (block_capacity_ == 0) ? 4 : block_capacity_ * 2;
+                TNode** new_blocks = new TNode*[new_cap];
+                for (int i = 0; i < block_count_; ++i) {
+                    new_blocks[i] = blocks_[i];
+                }
+                delete[] blocks_;
+                blocks_ = new_blocks;
+                block_capacity_ = new_cap;
+            }
+            TNode* block = new TNode[BLOCK_NODES];
+            blocks_[block_count_++] = block;
+            for (int i = 0; i < BLOCK_NODES; ++i) {
+                block[i].next = free_list_;
+                free_list_ = &block[i];
+            }
+        }
+        TNode* node = free_list_;
+        free_list_ = node->next;
+        return node;
+    }
+
+    /**
+     * @brief Returns a node to the free list.
+     *
+     * @param node The node to recycle; must already be unlinked.
+     */
+    void release_node(TNode* node) {
+        node->prev = 0;
+        node->next = free_list_;
+        free_list_ = node;
+    }
+
+    /**
+     * @brief Appends the node at the back of the bucket whose sentinel is
+     * given (same splice as DoublyLinkedList::insert(&sentinel, ...)).
+     */
+    static void link_before(TNode* sentinel, TNode* node) {
+        node->prev = sentinel->prev;
+        node->next = sentinel;
+        sentinel->prev->next = node;
+        sentinel->prev = node;
+    }
+
+    // Unlinks the node from whatever bucket it is in.
+    static void unlink(TNode* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+    }
+
+    /**
+     * @brief Places the node in the bucket that matches its expiry relative
+     * to current_.
+     *
+     * The level is picked by how far in the future the timer is, and the slot
+     * by the expiry bits of that level. A bucket at level k is cascaded
+     * exactly when the lower k levels wrap to the timer's slot, which is never
+     * later than its expiry.
+     *
+     * @param node The node to place; node->expiry must be > current_.
+     */
+    void place(TNode* node) {
+        unsigned int delta = node->expiry - current_;
+        int level = 0;
+        while (level < LEVELS - 1 &&
+               delta >= (1u << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        int slot = (node->expiry >> (SLOT_BITS * level)) & (SLOTS - 1);
+        link_before(&wheel_[level][slot], node);
+    }
+
+    /**
+     * @brief Moves every timer of the given bucket down to the level that
+     * matches its remaining delay.
+     *
+     * @param level Level of the bucket (>= 1).
+     * @param slot Slot of the bucket.
+     */
+    void cascade(int level, int slot) {
+        TNode* sentinel = &wheel_[level][slot];
+        if (sentinel->next == sentinel) {
+            return;
+        }
+        // Detach the whole ring first so re-placement never revisits a node.
+        TNode* curr = sentinel->next;
+        sentinel->prev->next = 0;
+        sentinel->next = sentinel;
+        sentinel->prev = sentinel;
+        while (curr != 0) {
+            TNode* next = curr->next;
+            place(curr);
+            curr = next;
+        }
+    }
+
+    /**
+     * @brief Processes a single tick: cascades the higher levels if the lower
+     * ones wrapped and then drains the current level-0 bucket into expired.
+     *
+     * @param expired Receives the payloads of the timers that fired.
+     */
+    void tick(Dequeue<T>& expired) {
+        ++current_;
+        for (int level = 1; level < LEVELS; ++level) {
+            unsigned int lower_mask = (1u << (SLOT_BITS * level)) - 1;
+            if ((current_ & lower_mask) != 0) {
+                break;
+            }
+            cascade(level, (current_ >> (SLOT_BITS * level)) & (SLOTS - 1));
+        }
+
+        TNode* sentinel = &wheel_[0][current_ & (SLOTS - 1)];
+        TNode* curr = sentinel->next;
+        while (curr != sentinel) {
+            TNode* next = curr->next;
+            expired.push_back(curr->data);
+            release_node(curr);
+            --size_;
+            curr = next;
+        }
+        sentinel->next = sentinel;
+        sentinel->prev = sentinel;
+    }
+
+    // Not copyable: handles point into this wheel's pool.
+    TimingWheel(TimingWheel const&);
+    TimingWheel& operator=(TimingWheel const&);
+
+  public:
+    // Constructor: empty wheel at tick 0
+    TimingWheel()
+        : current_(0), size_(0), free_list_(0), blocks_(0), block_count_(0),
+          block_capacity_(0) {}
+
+    // Destructor: frees every pool block (live timers are dropped).
+    ~TimingWheel() {
+        for (int i = 0; i < block_count_; ++i) {
+            delete[] blocks_[i];
+        }
+        delete[] blocks_;
+    }
+
+    // Number of live timers.
+    int size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    // The last tick processed by advance().
+    unsigned int now() const {
+        return current_;
+    }
+
+    /**
+     * @brief Schedules a timer that fires delay ticks from now.
+     *
+     * O(1): one pool pop and one splice into a bucket.
+     *
+     * @param delay Number of ticks until expiry; 0 is treated as 1 (the timer
+     * fires on the next processed tick).
+     * @param data Payload pushed to the expiry queue when the timer fires.
+     *
+     * @return Handle that can be passed to cancel() until the timer fires.
+     */
+    TNode* schedule(unsigned int delay, T const& data) {
+        if (delay == 0) {
+            delay = 1;
+        }
+        TNode* node = acquire_node();
+        node->expiry = current_ + delay;
+        node->data = data;
+        place(node);
+        ++size_;
+        return node;
+    }
+
+    /**
+     * @brief Cancels a pending timer.
+     *
+     * O(1): the node is unlinked from its bucket and recycled. The handle is
+     * invalid afterwards, as is any handle whose timer has already fired.
+     *
+     * @param handle Handle returned by schedule(); NULL is ignored.
+     */
+    void cancel(TNode* handle) {
+        if (handle == 0) {
+            return;
+        }
+        assert(handle->prev != 0);
+        unlink(handle);
+        release_node(handle);
+        --size_;
+    }
+
+    /**
+     * @brief Advances the wheel by the given number of ticks, appending the
+     * payload of every timer that fires to expired.
+     *
+     * Timers are appended in expiry order; timers sharing a tick keep their
+     * scheduling order unless they were cascaded from different buckets.
+     * Once the wheel is empty the remaining ticks are skipped in O(1).
+     *
+     * @param ticks Number of ticks to process.
+     * @param expired Queue that receives the expired payloads.
+     */
+    void advance(unsigned int ticks, Dequeue<T>& expired) {
+        while (ticks > 0 && size_ > 0) {
+            tick(expired);
+            --ticks;
+        }
+        current_ += ticks;
+    }
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,111 @@
+// bench_timing_wheel.cpp
+// Benchmark: hierarchical TimingWheel vs. Heap2-based timer scheduling.
+//
+// Each run schedules N timers with random delays, cancels half of them, and
+// then advances time until every remaining timer has fired. The heap variant
+// cancels by lazy deletion (a flag checked on pop), the way callers of Heap2
+// have to do it today.
+//
+// Usage: ./bin/bench_timing_wheel [N ...]   (default: 1000000 10000000)
+
+#include "BenchUtil.h"
+#include "Heap2.h"
+#include "TimingWheel.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static const unsigned int HORIZON = 1u << 20; // Delays are in [1, HORIZON].
+
+struct HeapTimer {
+    unsigned int expiry;
+    int id;
+    bool operator<(HeapTimer const& other) const {
+        return expiry < other.expiry;
+    }
+};
+
+static void bench_wheel(int n) {
+    TimingWheel<int> wheel;
+    TimerNode<int>** handles = new TimerNode<int>*[n];
+    Dequeue<int> expired;
+    XorShift32 rng(12345u);
+
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        handles[i] = wheel.schedule(1 + rng.next() % HORIZON, i);
+    }
+    double t_schedule = seconds_since(start);
+
+    start = clock();
+    for (int i = 0; i < n; i += 2) {
+        wheel.cancel(handles[i]);
+    }
+    double t_cancel = seconds_since(start);
+
+    start = clock();
+    unsigned long fired = 0;
+    while (!wheel.empty()) {
+        wheel.advance(1024, expired);
+        while (!expired.empty()) {
+            fired += expired.front();
+            expired.pop_front();
+        }
+    }
+    double t_expire = seconds_since(start);
+
+    std::printf("wheel  n=%-9d schedule %.3fs  cancel %.3fs  expire %.3fs  "
+                "total %.3fs  (checksum %lu)\n",
+                n, t_schedule, t_cancel, t_expire,
+                t_schedule + t_cancel + t_expire, fired);
+    delete[] handles;
+}
+
+static void bench_heap(int n) {
+    Heap2<HeapTimer> heap;
+    bool* cancelled = new bool[n];
+    XorShift32 rng(12345u);
+
+    clock_t start = clock();
+    for (int i = 0; i < n; ++i) {
+        HeapTimer timer;
+        timer.expiry = 1 + rng.next() % HORIZON;
+        timer.id = i;
+        heap.push(timer);
+        cancelled[i] = false;
+    }
+    double t_schedule = seconds_since(start);
+
+    start = clock();
+    for (int i = 0; i < n; i += 2) {
+        cancelled[i] = true;
+    }
+    double t_cancel = seconds_since(start);
+
+    start = clock();
+    unsigned long fired = 0;
+    while (heap.size() > 0) {
+        HeapTimer timer = heap.pop();
+        if (!cancelled[timer.id]) {
+            fired += timer.id;
+        }
+    }
+    double t_expire = seconds_since(start);
+
+    std::printf("heap2  n=%-9d schedule %.3fs  cancel %.3fs  expire %.3fs  "
+                "total %.3fs  (checksum %lu)\n",
+                n, t_schedule, t_cancel, t_expire,
+                t_schedule + t_cancel + t_expire, fired);
+    delete[] cancelled;
+}
+
+int main(int argc, char** argv) {
+    int default_sizes[] = {1000000, 10000000};
+    int count = argc > 1 ? argc - 1 : 2;
+    for (int i = 0; i < count; ++i) {
+        int n = argc > 1 ? std::atoi(argv[i + 1]) : default_sizes[i];
+        bench_wheel(n);
+        bench_heap(n);
+    }
+    return 0;
+}